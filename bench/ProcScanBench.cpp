@@ -0,0 +1,119 @@
+// Scan-time scaling of ProcScanner over a synthetic /proc fixture.
+//
+//   proc_scan_bench [processes] [iterations] [max-threads]
+//
+// Builds a temporary directory with one <pid>/stat file per fake process and
+// times ProcScanner::Scan() with 1..N worker threads against it, once with
+// plain open/read/close and once through io_uring.
+
+#include "ProcScanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+bool WriteFixture(const std::string& root, int processes) {
+    char path[512];
+    char line[512];
+    for (int pid = 1; pid <= processes; ++pid) {
+        std::snprintf(path, sizeof(path), "%s/%d", root.c_str(), pid);
+        if (mkdir(path, 0755) != 0) return false;
+        std::snprintf(path, sizeof(path), "%s/%d/stat", root.c_str(), pid);
+        int len = std::snprintf(line, sizeof(line),
+            "%d (worker-%d) S 1 %d %d 0 -1 4194560 1043 0 0 0 %d %d 0 0 20 0 4 0 %d "
+            "123456789 2048 18446744073709551615 1 1 0 0 0 0 0 4096 17663 0 0 0 17 %d 0 0 0 0 0 "
+            "0 0 0 0 0 0 0 0\n",
+            pid, pid % 64, pid, pid, pid * 3, pid, 1000 + pid, pid % 8);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        bool ok = write(fd, line, static_cast<size_t>(len)) == len;
+        close(fd);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+void RemoveFixture(const std::string& root, int processes) {
+    char path[512];
+    for (int pid = 1; pid <= processes; ++pid) {
+        std::snprintf(path, sizeof(path), "%s/%d/stat", root.c_str(), pid);
+        unlink(path);
+        std::snprintf(path, sizeof(path), "%s/%d", root.c_str(), pid);
+        rmdir(path);
+    }
+    rmdir(root.c_str());
+}
+
+double MedianScanMs(ProcScanner& scanner, int iterations) {
+    std::vector<ProcStatRecord> out;
+    scanner.Scan(out); // warm the dentry cache
+
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        scanner.Scan(out);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int processes = argc > 1 ? std::atoi(argv[1]) : 50000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    unsigned maxThreads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3]))
+                                   : std::max(1u, std::thread::hardware_concurrency());
+    if (processes <= 0 || iterations <= 0 || maxThreads == 0) {
+        std::fprintf(stderr, "usage: %s [processes] [iterations] [max-threads]\n", argv[0]);
+        return 1;
+    }
+
+    char tmpl[] = "/tmp/hud-procfs-XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::string root = tmpl;
+    if (!WriteFixture(root, processes)) {
+        std::perror("fixture");
+        RemoveFixture(root, processes);
+        return 1;
+    }
+
+    std::printf("%d synthetic processes, %d iterations, median scan time\n", processes, iterations);
+    std::printf("reader    threads  median ms  speedup  syscalls\n");
+
+    // Powers of two, plus the full hardware width
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    double baseline = 0.0;
+    for (bool uring : {false, true}) {
+        for (unsigned threads : threadCounts) {
+            ProcScanner scanner(root.c_str(), threads, uring);
+            if (uring && !scanner.UsingUring()) {
+                std::printf("io_uring  unavailable\n");
+                break;
+            }
+            double median = MedianScanMs(scanner, iterations);
+            if (baseline == 0.0) baseline = median;
+            std::printf("%-8s  %7u  %9.2f  %6.2fx  %8zu\n", uring ? "io_uring" : "syscall", threads, median,
+                        baseline / median, scanner.LastSyscallCount());
+        }
+    }
+
+    RemoveFixture(root, processes);
+    return 0;
+}
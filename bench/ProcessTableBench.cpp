@@ -0,0 +1,168 @@
+// Memory and allocation cost of ProcessTable on a synthetic process set.
+//
+//   process_table_bench [processes] [scans]
+//
+// Feeds the same records through BeginScan/Observe/EndScan and the tree
+// rollup repeatedly, with a few percent of processes churning per scan, and
+// counts heap allocations.
+// The "string per row" line is what one std::string name per process costs.
+// The top-20 lines compare TopSlots() with sorting every live slot.
+
+#include "ProcessTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+size_t g_allocations = 0;
+size_t g_allocatedBytes = 0;
+
+const char* const Names[] = {
+    "python3", "bash", "java", "sshd", "systemd", "node", "postgres", "nginx", "cc1plus", "ld",
+    "kworker/0:1-events", "kworker/u8:2-events_unbound", "kworker/R-mm_percpu_wq", "containerd-shim",
+    "dockerd", "gcc", "make", "ninja", "clang++", "rustc", "cargo", "go", "redis-server", "envoy",
+    "prometheus", "journald", "chronyd", "crond", "rsyslogd", "agetty", "ksoftirqd/3", "migration/7",
+    "rcu_preempt", "kthreadd", "irq/35-nvme0q1", "jbd2/nvme0n1p1-8", "xfsaild/dm-0", "udevd", "dbus-daemon",
+    "polkitd",
+};
+constexpr size_t NameCount = sizeof(Names) / sizeof(Names[0]);
+
+ProcStatRecord MakeRecord(int pid, unsigned long long startTime, unsigned tick) {
+    ProcStatRecord rec;
+    rec.pid = pid;
+    const char* name = Names[static_cast<size_t>(pid) % NameCount];
+    rec.commLen = static_cast<int>(std::strlen(name));
+    std::memcpy(rec.comm, name, static_cast<size_t>(rec.commLen));
+    rec.state = 'S';
+    rec.ppid = pid / 8; // a bushy tree, eight children per parent
+    rec.numThreads = 1 + pid % 16;
+    rec.startTime = startTime;
+    rec.utime = static_cast<unsigned long long>(pid) + (pid % 10 == 0 ? tick : 0);
+    rec.rssPages = 1000 + static_cast<unsigned long long>(pid % 5000);
+    rec.vsizeBytes = rec.rssPages * 4096 * 4;
+    rec.hasIo = true;
+    rec.ioReadBytes = static_cast<unsigned long long>(pid) * 4096 + (pid % 10 == 0 ? tick * 65536ull : 0);
+    rec.ioWriteBytes = rec.ioReadBytes / 2;
+    rec.ioSyscr = rec.ioReadBytes / 4096;
+    rec.ioSyscw = rec.ioWriteBytes / 4096;
+    // Every tenth process burns CPU and does I/O, and so changes its stat line each scan
+    rec.statHash = HashBytes(reinterpret_cast<const char*>(&rec.utime), sizeof(rec.utime)) ^
+                   static_cast<uint64_t>(pid);
+    return rec;
+}
+} // namespace
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    g_allocatedBytes += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    int processes = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int scans = argc > 2 ? std::atoi(argv[2]) : 100;
+    if (processes <= 0 || scans <= 0) {
+        std::fprintf(stderr, "usage: %s [processes] [scans]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<unsigned long long> startTimes(static_cast<size_t>(processes) + 1, 1);
+    ProcessTable table;
+    ProcessDelta delta;
+
+    auto runScan = [&](unsigned tick) {
+        // ~2% of pids are replaced by a new process every scan
+        for (int pid = 1 + static_cast<int>(tick) % 50; pid <= processes; pid += 50) {
+            startTimes[static_cast<size_t>(pid)] += 1000;
+        }
+        table.BeginScan();
+        for (int pid = 1; pid <= processes; ++pid) {
+            table.Observe(MakeRecord(pid, startTimes[static_cast<size_t>(pid)], tick));
+        }
+        table.EndScan();
+        table.ComputeRates(100.0, 1.0);
+        table.UpdateTree();
+        table.TakeDelta(delta);
+    };
+
+    runScan(0);
+    runScan(1); // let delta vectors reach steady-state capacity
+
+    size_t allocsBefore = g_allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scans; ++i) {
+        runScan(static_cast<unsigned>(i + 2));
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    size_t allocs = g_allocations - allocsBefore;
+
+    const ProcessTable::Columns& c = table.Cols();
+    size_t columnBytes = c.key.capacity() * sizeof(ProcessKey) + c.nameId.capacity() * sizeof(StringPool::Id) +
+                         c.statHash.capacity() * sizeof(uint64_t) + c.seenEpoch.capacity() * sizeof(uint32_t) +
+                         c.live.capacity() + c.state.capacity() + c.threads.capacity() * sizeof(uint32_t) +
+                         c.cpuTicks.capacity() * sizeof(uint64_t) * 2 + c.cpuPercent.capacity() * sizeof(float) +
+                         c.rssBytes.capacity() * sizeof(uint64_t) + c.vsizeBytes.capacity() * sizeof(uint64_t) +
+                         (c.pssBytes.capacity() + c.ussBytes.capacity() + c.swapBytes.capacity()) * sizeof(uint64_t) +
+                         c.memSampled.capacity() + c.hasIo.capacity() +
+                         (c.ioReadBytes.capacity() + c.ioWriteBytes.capacity() + c.ioSyscr.capacity() +
+                          c.ioSyscw.capacity()) * sizeof(uint64_t) * 2 +
+                         (c.ioReadRate.capacity() + c.ioWriteRate.capacity() + c.ioSyscrRate.capacity() +
+                          c.ioSyscwRate.capacity()) * sizeof(float) +
+                         c.pidText.capacity() * sizeof(c.pidText[0]) + c.ppid.capacity() * sizeof(int) +
+                         (c.parent.capacity() + c.firstChild.capacity() + c.nextSibling.capacity() +
+                          c.prevSibling.capacity()) * sizeof(int32_t) +
+                         (c.depth.capacity() + c.descendants.capacity()) * sizeof(uint32_t) +
+                         c.subtreeCpu.capacity() * sizeof(float) + c.subtreeRss.capacity() * sizeof(uint64_t);
+    size_t slots = table.SlotCount();
+
+    // Baseline: one std::string per row (heap only for names past the SSO buffer)
+    size_t stringBytes = 0;
+    for (int pid = 1; pid <= processes; ++pid) {
+        size_t len = std::strlen(Names[static_cast<size_t>(pid) % NameCount]);
+        stringBytes += sizeof(std::string) + (len > 15 ? len + 1 : 0);
+    }
+
+    constexpr int TopRuns = 200;
+    std::vector<uint32_t> top;
+    auto topStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < TopRuns; ++i) {
+        table.TopSlots(static_cast<TopMetric>(i % 3), 20, top);
+    }
+    std::chrono::duration<double, std::milli> topElapsed = std::chrono::steady_clock::now() - topStart;
+
+    std::vector<uint32_t> order;
+    auto sortStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < TopRuns; ++i) {
+        order.clear();
+        table.ForEachSlot([&](uint32_t slot) { order.push_back(slot); });
+        const auto& cpu = c.cpuPercent;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return cpu[a] > cpu[b]; });
+    }
+    std::chrono::duration<double, std::milli> sortElapsed = std::chrono::steady_clock::now() - sortStart;
+
+    std::printf("%d processes, %zu distinct names, %d scans in %.2f ms (%.3f ms/scan)\n", processes,
+                table.Names().Size() - 1, scans, elapsed.count(), elapsed.count() / scans);
+    std::printf("allocations per scan:        %.2f\n", static_cast<double>(allocs) / scans);
+    std::printf("column bytes per process:    %.1f\n", static_cast<double>(columnBytes) / slots);
+    std::printf("name bytes per process:      %.1f (4-byte id + %zu pooled bytes shared)\n",
+                4.0 + static_cast<double>(table.Names().Bytes()) / slots, table.Names().Bytes());
+    std::printf("string-per-row name bytes:   %.1f\n", static_cast<double>(stringBytes) / processes);
+    std::printf("top-20 (bounded heap):       %.3f ms\n", topElapsed.count() / TopRuns);
+    std::printf("top-20 (full sort):          %.3f ms\n", sortElapsed.count() / TopRuns);
+    return 0;
+}
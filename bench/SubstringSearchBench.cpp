@@ -0,0 +1,144 @@
+// Case-insensitive substring search over a synthetic process list.
+//
+//   substring_search_bench [entries] [iterations]
+//
+// Times one filter pass over every entry for a short comm-style field and a
+// long cmdline-style field, per search kernel, next to the lowercase-copy +
+// std::string::find approach the filter used to take. Each kernel also runs
+// over the entries stored back to back with trailing padding, the way
+// SearchIndex keeps them: once per entry with the padded kernel, and as one
+// pass over the whole buffer with hits mapped back to entries.
+
+#include "SubstringSearch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+const char* const Words[] = {
+    "python3", "/usr/bin/Java", "--config", "/etc/Nginx/nginx.conf", "-Xmx4g", "worker", "node",
+    "/opt/App/server.js", "--port=8080", "postgres:", "checkpointer", "-jar", "Service.jar",
+    "--log-level=INFO", "kworker/u8:2", "containerd-shim-runc-v2", "-namespace", "k8s.io", "-id",
+};
+constexpr size_t WordCount = sizeof(Words) / sizeof(Words[0]);
+
+std::string MakeLine(size_t seed, size_t words) {
+    std::string s;
+    for (size_t i = 0; i < words; ++i) {
+        if (i) s += ' ';
+        s += Words[(seed * 7 + i * 13) % WordCount];
+        s += std::to_string((seed + i) % 1000);
+    }
+    return s;
+}
+
+template <typename Fn>
+double TimeMs(int iterations, size_t& matches, Fn&& pass) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) matches = pass();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+// Entries separated by NUL, with SearchPadding bytes after the last
+struct Packed {
+    std::string text;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+};
+
+Packed Pack(const std::vector<std::string>& lines) {
+    Packed p;
+    for (const auto& l : lines) {
+        p.offsets.push_back(static_cast<uint32_t>(p.text.size()));
+        p.lengths.push_back(static_cast<uint32_t>(l.size()));
+        p.text.append(l).append(1, '\0');
+    }
+    p.text.append(SearchPadding, '\0');
+    return p;
+}
+
+void Run(const char* label, const std::vector<std::string>& lines, const std::string& needle, int iterations) {
+    size_t bytes = 0;
+    for (const auto& l : lines) bytes += l.size();
+    std::printf("%s: %zu entries, %.1f bytes avg, needle \"%s\"\n", label, lines.size(),
+                static_cast<double>(bytes) / lines.size(), needle.c_str());
+
+    size_t matches = 0;
+    double ms = TimeMs(iterations, matches, [&] {
+        size_t n = 0;
+        for (const auto& l : lines) {
+            std::string lower = l;
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            n += lower.find(needle) != std::string::npos;
+        }
+        return n;
+    });
+    std::printf("  %-14s %8.3f ms  (%zu matches)\n", "lower+find", ms, matches);
+
+    const Packed packed = Pack(lines);
+    const std::string_view text(packed.text.data(), packed.text.size() - SearchPadding);
+    const SearchKernel best = BestSearchKernel();
+    for (SearchKernel k : {SearchKernel::Scalar, SearchKernel::Sse2, SearchKernel::Avx2}) {
+        if (static_cast<int>(k) > static_cast<int>(best)) break;
+        ms = TimeMs(iterations, matches, [&] {
+            size_t n = 0;
+            for (const auto& l : lines) n += FindIgnoreCase(k, l, needle) != std::string_view::npos;
+            return n;
+        });
+        std::printf("  %-14s %8.3f ms  (%zu matches)\n", SearchKernelName(k), ms, matches);
+
+        ms = TimeMs(iterations, matches, [&] {
+            size_t n = 0;
+            for (size_t i = 0; i < packed.offsets.size(); ++i) {
+                std::string_view entry(packed.text.data() + packed.offsets[i], packed.lengths[i]);
+                n += FindIgnoreCasePadded(k, entry, needle) != std::string_view::npos;
+            }
+            return n;
+        });
+        std::printf("  %-14s %8.3f ms  (%zu matches)\n", (std::string(SearchKernelName(k)) + " padded").c_str(), ms,
+                    matches);
+
+        ms = TimeMs(iterations, matches, [&] {
+            size_t n = 0;
+            size_t i = 0;
+            for (size_t pos = 0; pos < text.size(); ++i) {
+                size_t hit = FindIgnoreCase(k, text.substr(pos), needle);
+                if (hit == std::string_view::npos) break;
+                hit += pos;
+                while (packed.offsets[i] + packed.lengths[i] < hit) ++i;
+                ++n;
+                pos = packed.offsets[i] + packed.lengths[i] + 1;
+            }
+            return n;
+        });
+        std::printf("  %-14s %8.3f ms  (%zu matches)\n", (std::string(SearchKernelName(k)) + " one pass").c_str(),
+                    ms, matches);
+    }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int entries = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (entries <= 0 || iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [entries] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> comms, cmdlines;
+    for (size_t i = 0; i < static_cast<size_t>(entries); ++i) {
+        comms.push_back(MakeLine(i, 1).substr(0, 15));
+        cmdlines.push_back(MakeLine(i, 6 + i % 10));
+    }
+
+    Run("comm", comms, "nginx", iterations);
+    Run("cmdline", cmdlines, "service.jar", iterations);
+    return 0;
+}
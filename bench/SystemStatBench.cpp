@@ -0,0 +1,155 @@
+// Cost of one /proc/stat sample: the std::ifstream path SystemMonitor used to
+// take against SystemStatReader's pread and hand-written scanner.
+//
+//   system_stat_bench [cores] [iterations]
+//
+// Both readers run against a synthetic /proc/stat with the given number of
+// cpuN lines and a 1024-source intr line, so the numbers aren't dominated by
+// the kernel generating the real file. The parse-only line skips the read,
+// and the last line times SystemStatReader on this machine's /proc/stat.
+
+#include "SystemStat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+size_t g_allocations = 0;
+
+std::string MakeFixture(int cores) {
+    std::string text;
+    char line[256];
+    auto cpuLine = [&](const char* label, unsigned long long scale) {
+        std::snprintf(line, sizeof(line), "%s %llu %llu %llu %llu %llu %llu %llu %llu 0 0\n", label, 86783 * scale,
+                      12 * scale, 7833 * scale, 288776 * scale, 376 * scale, 3 * scale, 5 * scale, 759 * scale);
+        text += line;
+    };
+    cpuLine("cpu ", static_cast<unsigned long long>(cores));
+    for (int i = 0; i < cores; ++i) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "cpu%d", i);
+        cpuLine(label, 1);
+    }
+    text += "intr 487345";
+    for (int i = 0; i < 1024; ++i) text += i % 7 == 0 ? " 1197" : " 0";
+    text += "\nctxt 814013\nbtime 1792112740\nprocesses 9121\nprocs_running 3\nprocs_blocked 0\n"
+            "softirq 143353 0 67494 1 7037 0 0 1 0 43 68777\n";
+    return text;
+}
+
+// SystemMonitor::SampleCpuUsage() before SystemStatReader, without the usage math
+struct IostreamSampler {
+    std::vector<unsigned long long> coreTotal;
+    unsigned long long total = 0;
+
+    bool Sample(const char* path) {
+        std::ifstream stat(path);
+        if (!stat) return false;
+        std::string cpuLabel;
+        while (stat >> cpuLabel && cpuLabel.compare(0, 3, "cpu") == 0) {
+            unsigned long long user = 0, nice = 0, system = 0, idle = 0;
+            unsigned long long iowait = 0, irq = 0, softirq = 0, steal = 0;
+            stat >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+            stat.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            unsigned long long sum = user + nice + system + idle + iowait + irq + softirq + steal;
+            if (cpuLabel.size() > 3) {
+                size_t core = std::strtoul(cpuLabel.c_str() + 3, nullptr, 10);
+                if (core >= coreTotal.size()) coreTotal.resize(core + 1);
+                coreTotal[core] = sum;
+            } else {
+                total = sum;
+            }
+        }
+        return true;
+    }
+};
+
+// Median ns per call of fn, and heap allocations per call
+template <typename Fn>
+void Measure(const char* label, int iterations, int cores, Fn&& fn) {
+    fn(); // warm up: first-call allocations and the page cache
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(iterations));
+    const size_t allocationsBefore = g_allocations;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    const double allocations = static_cast<double>(g_allocations - allocationsBefore) / iterations;
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    const double median = samples[samples.size() / 2];
+    std::printf("%-26s  %10.0f  %8.1f  %11.1f\n", label, median, median / cores, allocations);
+}
+} // namespace
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    int cores = argc > 1 ? std::atoi(argv[1]) : 128;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10000;
+    if (cores <= 0 || iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [cores] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    char path[] = "/tmp/hud-stat-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 1;
+    }
+    const std::string text = MakeFixture(cores);
+    const bool written = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+    if (!written) {
+        std::perror("fixture");
+        unlink(path);
+        return 1;
+    }
+
+    std::printf("%d cores, %zu byte /proc/stat, %d iterations\n", cores, text.size(), iterations);
+    std::printf("reader                      median ns  ns/core  allocs/call\n");
+
+    IostreamSampler iostream;
+    Measure("ifstream + operator>>", iterations, cores, [&] { iostream.Sample(path); });
+
+    SystemStat stat;
+    SystemStatReader reader(path);
+    Measure("pread + scanner", iterations, cores, [&] { reader.Read(stat); });
+    Measure("scanner only", iterations, cores, [&] { ParseSystemStat(text.data(), text.size(), stat); });
+
+    SystemStatReader live;
+    SystemStat liveStat;
+    if (live.Read(liveStat)) {
+        const int liveCores = std::max<int>(1, static_cast<int>(liveStat.cores.size()));
+        std::printf("\nthis machine, %d cores (includes the kernel formatting the file)\n", liveCores);
+        Measure("pread + scanner", iterations, liveCores, [&] { live.Read(liveStat); });
+    }
+
+    unlink(path);
+    return 0;
+}
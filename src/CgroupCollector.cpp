@@ -0,0 +1,322 @@
+#include "CgroupCollector.h"
+
+#include <cstring>
+#include <string_view>
+
+#if defined(__linux__)
+#include "ProcScanner.h"
+
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+uint64_t ParseU64(const char*& p, const char* end) {
+    uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    return v;
+}
+
+// Calls fn(name, value) for every "name value" line of a flat-keyed file
+template <typename Fn>
+void ForEachKeyValue(const char* text, size_t len, Fn&& fn) {
+    const char* end = text + len;
+    for (const char* line = text; line < end;) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (!eol) eol = end;
+        const char* space = static_cast<const char*>(std::memchr(line, ' ', static_cast<size_t>(eol - line)));
+        if (space) {
+            const char* p = space + 1;
+            fn(std::string_view(line, static_cast<size_t>(space - line)), ParseU64(p, eol));
+        }
+        line = eol + 1;
+    }
+}
+} // namespace
+
+bool ParseProcCgroup(const char* text, size_t len, std::string& path) {
+    const char* end = text + len;
+    for (const char* line = text; line < end;) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (!eol) eol = end;
+        // v1 hierarchies have an id and controller names; the unified one is "0::"
+        if (eol - line >= 4 && std::memcmp(line, "0::", 3) == 0) {
+            path.assign(line + 3, static_cast<size_t>(eol - line - 3));
+            return true;
+        }
+        line = eol + 1;
+    }
+    return false;
+}
+
+bool ParseCgroupCpuStat(const char* text, size_t len, CgroupCounters& out) {
+    bool found = false;
+    ForEachKeyValue(text, len, [&](std::string_view name, uint64_t value) {
+        if (name == "usage_usec") {
+            out.usageUsec = value;
+            found = true;
+        } else if (name == "user_usec") {
+            out.userUsec = value;
+        } else if (name == "system_usec") {
+            out.systemUsec = value;
+        } else if (name == "throttled_usec") {
+            out.throttledUsec = value;
+        }
+    });
+    return found;
+}
+
+bool ParseCgroupMemoryStat(const char* text, size_t len, CgroupCounters& out) {
+    bool found = false;
+    ForEachKeyValue(text, len, [&](std::string_view name, uint64_t value) {
+        if (name == "anon") {
+            out.anonBytes = value;
+            found = true;
+        } else if (name == "file") {
+            out.fileBytes = value;
+            found = true;
+        }
+    });
+    return found;
+}
+
+bool ParseCgroupIoStat(const char* text, size_t len, CgroupCounters& out) {
+    // One line per device: "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0"
+    bool found = false;
+    const char* end = text + len;
+    const char* p = text;
+    while (p < end) {
+        // Skip the device number, then read key=value pairs to the end of the line
+        while (p < end && *p != ' ' && *p != '\n') ++p;
+        while (p < end && *p == ' ') {
+            ++p;
+            const char* eq = p;
+            while (eq < end && *eq != '=' && *eq != ' ' && *eq != '\n') ++eq;
+            if (eq >= end || *eq != '=') {
+                p = eq;
+                continue;
+            }
+            std::string_view key(p, static_cast<size_t>(eq - p));
+            p = eq + 1;
+            const uint64_t value = ParseU64(p, end);
+            if (key == "rbytes") {
+                out.ioReadBytes += value;
+                found = true;
+            } else if (key == "wbytes") {
+                out.ioWriteBytes += value;
+            } else if (key == "rios") {
+                out.ioReadOps += value;
+            } else if (key == "wios") {
+                out.ioWriteOps += value;
+            }
+        }
+        while (p < end && *p != '\n') ++p;
+        ++p;
+    }
+    return found;
+}
+
+#if defined(__linux__)
+namespace {
+constexpr size_t BufferSize = 16 * 1024;
+constexpr const char* FileNames[] = {"cpu.stat", "memory.current", "memory.stat", "io.stat"};
+
+int OpenCgroupRoot(const char* path) {
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    // Only the root of a v2 hierarchy has this file
+    if (faccessat(fd, "cgroup.controllers", F_OK, 0) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+uint64_t Delta(uint64_t cur, uint64_t prev) {
+    // A group removed and recreated under the same path starts over
+    return cur >= prev ? cur - prev : 0;
+}
+} // namespace
+
+CgroupCollector::CgroupCollector(const char* procRoot, const char* cgroupRoot)
+    : m_buffer(BufferSize), m_fdBudget(ProcScanner::FdPoolShare(FdShare::Cgroups)) {
+    m_procFd = open(procRoot, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (cgroupRoot) {
+        m_rootFd = OpenCgroupRoot(cgroupRoot);
+    } else {
+        m_rootFd = OpenCgroupRoot("/sys/fs/cgroup");
+        if (m_rootFd < 0) m_rootFd = OpenCgroupRoot("/sys/fs/cgroup/unified");
+    }
+    if (m_procFd < 0 && m_rootFd >= 0) {
+        close(m_rootFd);
+        m_rootFd = -1;
+    }
+}
+
+CgroupCollector::~CgroupCollector() {
+    for (Group& g : m_groups) {
+        CloseFiles(g);
+    }
+    if (m_rootFd >= 0) close(m_rootFd);
+    if (m_procFd >= 0) close(m_procFd);
+}
+
+void CgroupCollector::Apply(const ProcessDelta& delta) {
+    if (!IsAvailable()) return;
+    for (const ProcessKey& key : delta.removed) {
+        auto it = m_groupOf.find(key);
+        if (it == m_groupOf.end()) continue;
+        Leave(it->second);
+        m_groupOf.erase(it);
+    }
+    std::string path;
+    for (const ProcessKey& key : delta.added) {
+        // Gone already, or a v1-only process view: it just isn't counted
+        if (m_groupOf.count(key) || !ReadProcessCgroup(key.pid, path)) continue;
+        m_groupOf.emplace(key, Join(path));
+    }
+}
+
+void CgroupCollector::Collect(std::chrono::steady_clock::time_point now) {
+    if (!IsAvailable()) return;
+    auto start = std::chrono::steady_clock::now();
+    m_lastReads = 0;
+    const bool haveInterval = m_lastCollect != std::chrono::steady_clock::time_point{};
+    const double seconds = haveInterval ? std::chrono::duration<double>(now - m_lastCollect).count() : 0.0;
+    m_lastCollect = now;
+
+    for (Group& g : m_groups) {
+        if (g.processes == 0) continue;
+        CgroupCounters cur;
+        size_t len = 0;
+        const bool hasCpu = ReadGroupFile(g, CpuStat, len) && ParseCgroupCpuStat(m_buffer.data(), len, cur);
+        CgroupStats& s = g.stats;
+        s.processes = g.processes;
+        s.hasMemory = ReadGroupFile(g, MemoryCurrent, len);
+        if (s.hasMemory) {
+            const char* p = m_buffer.data();
+            cur.memoryCurrent = ParseU64(p, p + len);
+            if (ReadGroupFile(g, MemoryStat, len)) ParseCgroupMemoryStat(m_buffer.data(), len, cur);
+        }
+        // Empty until the group's first I/O, which still counts as present
+        s.hasIo = ReadGroupFile(g, IoStat, len);
+        if (s.hasIo) ParseCgroupIoStat(m_buffer.data(), len, cur);
+
+        s.memoryBytes = cur.memoryCurrent;
+        s.anonBytes = cur.anonBytes;
+        s.fileBytes = cur.fileBytes;
+
+        // Counters are cumulative; the first reading of a group only sets the baseline
+        const double perSecond = g.sampled && seconds > 0.0 ? 1.0 / seconds : 0.0;
+        auto rate = [&](uint64_t c, uint64_t p) {
+            return static_cast<float>(static_cast<double>(Delta(c, p)) * perSecond);
+        };
+        // usec per second / 1e4 = percent of one core
+        s.cpuPercent = hasCpu ? rate(cur.usageUsec, g.prev.usageUsec) / 1e4f : 0.0f;
+        s.userPercent = hasCpu ? rate(cur.userUsec, g.prev.userUsec) / 1e4f : 0.0f;
+        s.systemPercent = hasCpu ? rate(cur.systemUsec, g.prev.systemUsec) / 1e4f : 0.0f;
+        s.throttledPercent = hasCpu ? rate(cur.throttledUsec, g.prev.throttledUsec) / 1e4f : 0.0f;
+        s.ioReadRate = rate(cur.ioReadBytes, g.prev.ioReadBytes);
+        s.ioWriteRate = rate(cur.ioWriteBytes, g.prev.ioWriteBytes);
+        s.ioReadOpsRate = rate(cur.ioReadOps, g.prev.ioReadOps);
+        s.ioWriteOpsRate = rate(cur.ioWriteOps, g.prev.ioWriteOps);
+        g.prev = cur;
+        g.sampled = true;
+    }
+
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    m_lastMs = elapsed.count();
+}
+
+void CgroupCollector::Stats(std::vector<CgroupStats>& out) const {
+    for (const Group& g : m_groups) {
+        if (g.processes > 0 && g.sampled) out.push_back(g.stats);
+    }
+}
+
+bool CgroupCollector::ReadProcessCgroup(int pid, std::string& path) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%d/cgroup", pid);
+    int fd = openat(m_procFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t n = read(fd, m_buffer.data(), m_buffer.size());
+    close(fd);
+    return n > 0 && ParseProcCgroup(m_buffer.data(), static_cast<size_t>(n), path);
+}
+
+uint32_t CgroupCollector::Join(const std::string& path) {
+    auto it = m_groupByPath.find(path);
+    if (it != m_groupByPath.end()) {
+        ++m_groups[it->second].processes;
+        return it->second;
+    }
+    uint32_t index;
+    if (!m_freeGroups.empty()) {
+        index = m_freeGroups.back();
+        m_freeGroups.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_groups.size());
+        m_groups.emplace_back();
+    }
+    Group& g = m_groups[index];
+    g = Group{};
+    g.path = path;
+    g.processes = 1;
+    g.stats.path = path;
+    m_groupByPath.emplace(path, index);
+    return index;
+}
+
+void CgroupCollector::Leave(uint32_t index) {
+    Group& g = m_groups[index];
+    if (--g.processes > 0) return;
+    CloseFiles(g);
+    m_groupByPath.erase(g.path);
+    m_freeGroups.push_back(index);
+}
+
+bool CgroupCollector::ReadGroupFile(Group& g, FileIndex which, size_t& len) {
+    File& f = g.files[which];
+    if (f.missing) return false;
+    ssize_t n;
+    if (f.fd >= 0) {
+        n = pread(f.fd, m_buffer.data(), m_buffer.size(), 0);
+    } else {
+        // Paths are relative to the root descriptor; the root group itself is "/"
+        m_filePath.assign(g.path.size() > 1 ? g.path.c_str() + 1 : "");
+        if (!m_filePath.empty()) m_filePath += '/';
+        m_filePath += FileNames[which];
+        int fd = openat(m_rootFd, m_filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            f.missing = errno == ENOENT;
+            return false;
+        }
+        n = read(fd, m_buffer.data(), m_buffer.size());
+        if (n >= 0 && m_openFds < m_fdBudget) {
+            f.fd = fd;
+            ++m_openFds;
+        } else {
+            close(fd);
+        }
+    }
+    ++m_lastReads;
+    if (n < 0) return false; // ENODEV once the group is removed
+    len = static_cast<size_t>(n);
+    return true;
+}
+
+void CgroupCollector::CloseFiles(Group& g) {
+    for (File& f : g.files) {
+        if (f.fd < 0) continue;
+        close(f.fd);
+        f.fd = -1;
+        --m_openFds;
+    }
+}
+#endif
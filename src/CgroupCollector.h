@@ -0,0 +1,143 @@
+#pragma once
+
+#include "ProcessTable.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <array>
+#include <chrono>
+#include <unordered_map>
+#endif
+
+// Resource usage of one cgroup v2 group over the last collection interval.
+// Fields whose controller isn't enabled for the group stay zero with the
+// matching has* flag unset.
+struct CgroupStats {
+    std::string path;          // relative to the cgroup root, "/" for the root group
+    uint32_t processes = 0;    // live processes that belong to it
+    float cpuPercent = 0.0f;   // 100 = one fully busy core
+    float userPercent = 0.0f;
+    float systemPercent = 0.0f;
+    float throttledPercent = 0.0f; // of wall time spent throttled by cpu.max
+
+    bool hasMemory = false;
+    uint64_t memoryBytes = 0;  // memory.current: everything charged to the group
+    uint64_t anonBytes = 0;    // from memory.stat
+    uint64_t fileBytes = 0;    // page cache
+
+    bool hasIo = false;
+    float ioReadRate = 0.0f;   // bytes/s, summed over devices
+    float ioWriteRate = 0.0f;
+    float ioReadOpsRate = 0.0f;
+    float ioWriteOpsRate = 0.0f;
+};
+
+// Raw cumulative counters from a group's accounting files
+struct CgroupCounters {
+    uint64_t usageUsec = 0;
+    uint64_t userUsec = 0;
+    uint64_t systemUsec = 0;
+    uint64_t throttledUsec = 0;
+    uint64_t memoryCurrent = 0;
+    uint64_t anonBytes = 0;
+    uint64_t fileBytes = 0;
+    uint64_t ioReadBytes = 0;
+    uint64_t ioWriteBytes = 0;
+    uint64_t ioReadOps = 0;
+    uint64_t ioWriteOps = 0;
+};
+
+// Path from the "0::<path>" line of /proc/<pid>/cgroup. Returns false on
+// cgroup v1-only hosts, where that line is missing.
+bool ParseProcCgroup(const char* text, size_t len, std::string& path);
+
+// Parsers for cpu.stat, memory.stat and io.stat. Each fills only its own
+// fields of out and returns false if none of them were found.
+bool ParseCgroupCpuStat(const char* text, size_t len, CgroupCounters& out);
+bool ParseCgroupMemoryStat(const char* text, size_t len, CgroupCounters& out);
+bool ParseCgroupIoStat(const char* text, size_t len, CgroupCounters& out);
+
+#if defined(__linux__)
+// Groups processes by cgroup v2 path and reads each active group's own
+// accounting files, which the kernel keeps per group, instead of summing the
+// group's processes. A process's cgroup is read once, when it enters the
+// process table; later migrations (rare outside of service startup) aren't
+// followed.
+//
+// Accounting file descriptors stay open while a group has processes and are
+// re-read with pread, like ProcScanner's stat descriptors. Everything runs on
+// the thread that owns the process table.
+class CgroupCollector {
+public:
+    // cgroupRoot == nullptr picks /sys/fs/cgroup, or the unified hierarchy of
+    // a systemd hybrid layout
+    explicit CgroupCollector(const char* procRoot = "/proc", const char* cgroupRoot = nullptr);
+    ~CgroupCollector();
+
+    CgroupCollector(const CgroupCollector&) = delete;
+    CgroupCollector& operator=(const CgroupCollector&) = delete;
+
+    // False without a cgroup v2 hierarchy; Apply() and Collect() do nothing then
+    bool IsAvailable() const { return m_rootFd >= 0; }
+
+    // Tracks membership from a table delta, reading /proc/<pid>/cgroup of
+    // each added process
+    void Apply(const ProcessDelta& delta);
+
+    // Reads the accounting files of every group with live processes and
+    // turns them into rates against the previous call
+    void Collect(std::chrono::steady_clock::time_point now);
+
+    // Appends every active group as of the last Collect()
+    void Stats(std::vector<CgroupStats>& out) const;
+
+    size_t GroupCount() const { return m_groupByPath.size(); }
+    // Files read and time spent by the last Collect()
+    size_t LastFileReads() const { return m_lastReads; }
+    float LastCollectMs() const { return m_lastMs; }
+
+    // Upper bound on accounting descriptors kept open across calls: the
+    // collector's share of ProcScanner's descriptor pool
+    size_t FdBudget() const { return m_fdBudget; }
+
+private:
+    enum FileIndex { CpuStat, MemoryCurrent, MemoryStat, IoStat, FileCount };
+
+    struct File {
+        int fd = -1;
+        bool missing = false; // controller not enabled here; not retried
+    };
+
+    struct Group {
+        std::string path;
+        uint32_t processes = 0;
+        bool sampled = false; // prev holds a previous reading
+        std::array<File, FileCount> files{};
+        CgroupCounters prev;
+        CgroupStats stats;
+    };
+
+    bool ReadProcessCgroup(int pid, std::string& path);
+    uint32_t Join(const std::string& path);
+    void Leave(uint32_t index);
+    bool ReadGroupFile(Group& g, FileIndex which, size_t& len);
+    void CloseFiles(Group& g);
+
+    int m_procFd = -1;
+    int m_rootFd = -1;
+    std::vector<Group> m_groups;
+    std::vector<uint32_t> m_freeGroups;
+    std::unordered_map<std::string, uint32_t> m_groupByPath;
+    std::unordered_map<ProcessKey, uint32_t, ProcessKeyHash> m_groupOf;
+    std::vector<char> m_buffer;
+    std::string m_filePath; // scratch
+    size_t m_fdBudget = 0;
+    size_t m_openFds = 0;
+    std::chrono::steady_clock::time_point m_lastCollect{};
+    size_t m_lastReads = 0;
+    float m_lastMs = 0.0f;
+};
+#endif
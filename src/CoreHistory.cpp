@@ -0,0 +1,20 @@
+#include "CoreHistory.h"
+
+#include <algorithm>
+
+void CoreHistory::Reset(size_t cores, size_t length) {
+    m_cores = cores;
+    m_length = length;
+    m_size = 0;
+    m_head = 0;
+    m_data.assign(cores * length, 0.0f);
+    ++m_version;
+}
+
+void CoreHistory::Push(const float* usage) {
+    if (m_length == 0) return;
+    std::copy(usage, usage + m_cores, m_data.begin() + static_cast<std::ptrdiff_t>(m_head * m_cores));
+    m_head = (m_head + 1) % m_length;
+    m_size = std::min(m_size + 1, m_length);
+    ++m_version;
+}
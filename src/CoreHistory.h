@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-core CPU utilization over time, kept as one contiguous block of
+// Length() rows of Cores() values used as a ring. A tick writes one row in
+// place, so its cost grows with the core count only by a copy, and a reader
+// walks plain memory instead of one container per core.
+class CoreHistory {
+public:
+    // Drops all samples; every row holds cores values from now on
+    void Reset(size_t cores, size_t length);
+
+    // Appends one sample: usage[i] is core i's utilization, 0..100
+    void Push(const float* usage);
+
+    size_t Cores() const { return m_cores; }
+    size_t Length() const { return m_length; }
+    size_t Size() const { return m_size; } // samples held, up to Length()
+
+    // Row i of the held samples, 0 = oldest
+    const float* Row(size_t i) const {
+        return m_data.data() + ((m_head + m_length - m_size + i) % m_length) * m_cores;
+    }
+
+    // Bumped by every Push() and Reset(), so copies can be skipped when unchanged
+    uint64_t Version() const { return m_version; }
+
+private:
+    size_t m_cores = 0;
+    size_t m_length = 0;
+    size_t m_size = 0;
+    size_t m_head = 0; // row the next Push() writes
+    uint64_t m_version = 0;
+    std::vector<float> m_data;
+};
@@ -0,0 +1,86 @@
+#include "HeavyHitters.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+HeavyHitters::HeavyHitters() : m_buckets(BucketCount) {}
+
+int64_t HeavyHitters::BucketIndex(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count() / BucketSpan.count();
+}
+
+void HeavyHitters::Add(Clock::time_point now, uint32_t key, uint64_t weight) {
+    if (weight == 0) return;
+    const int64_t index = BucketIndex(now);
+    Bucket& b = m_buckets[static_cast<size_t>(index) % BucketCount];
+    if (b.index != index) {
+        // The slot's previous occupant has aged out of every window
+        b.index = index;
+        b.size = 0;
+        b.total = 0;
+    }
+    b.total += weight;
+
+    // 64 keys: a linear probe beats hashing and keeps the bucket allocation-free
+    for (uint32_t i = 0; i < b.size; ++i) {
+        if (b.keys[i] == key) {
+            b.weights[i] += weight;
+            return;
+        }
+    }
+    if (b.size < Counters) {
+        b.keys[b.size] = key;
+        b.weights[b.size] = weight;
+        b.errors[b.size] = 0;
+        ++b.size;
+        return;
+    }
+    // Full: the new key takes over the lightest counter and inherits its
+    // weight as error
+    const size_t victim = static_cast<size_t>(std::min_element(b.weights.begin(), b.weights.end()) - b.weights.begin());
+    b.keys[victim] = key;
+    b.errors[victim] = b.weights[victim];
+    b.weights[victim] += weight;
+}
+
+uint64_t HeavyHitters::Top(Clock::time_point now, std::chrono::seconds window, size_t k,
+                           std::vector<Entry>& out) const {
+    out.clear();
+    const int64_t newest = BucketIndex(now);
+    int64_t spans = (window.count() + BucketSpan.count() - 1) / BucketSpan.count();
+    spans = std::clamp<int64_t>(spans, 1, static_cast<int64_t>(BucketCount));
+
+    struct Merged {
+        uint64_t weight = 0;
+        int64_t slack = 0; // own error minus the floor of each bucket it appears in
+    };
+    std::unordered_map<uint32_t, Merged> merged;
+    uint64_t total = 0;
+    uint64_t floors = 0; // sum of the lightest counter of each full bucket
+    for (int64_t index = newest - spans + 1; index <= newest; ++index) {
+        if (index < 0) continue;
+        const Bucket& b = m_buckets[static_cast<size_t>(index) % BucketCount];
+        if (b.index != index) continue;
+        total += b.total;
+        // A key missing from a full bucket may have had up to its lightest weight there
+        const uint64_t floor = b.size == Counters ? *std::min_element(b.weights.begin(), b.weights.end()) : 0;
+        floors += floor;
+        for (uint32_t i = 0; i < b.size; ++i) {
+            Merged& m = merged[b.keys[i]];
+            m.weight += b.weights[i];
+            m.slack += static_cast<int64_t>(b.errors[i]) - static_cast<int64_t>(floor);
+        }
+    }
+
+    out.reserve(merged.size());
+    for (const auto& [key, m] : merged) {
+        out.push_back(Entry{key, m.weight, static_cast<uint64_t>(static_cast<int64_t>(floors) + m.slack)});
+    }
+    const size_t n = std::min(k, out.size());
+    std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n), out.end(),
+                      [](const Entry& a, const Entry& b) {
+                          return a.weight != b.weight ? a.weight > b.weight : a.key < b.key;
+                      });
+    out.resize(n);
+    return total;
+}
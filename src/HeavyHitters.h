@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sliding-window heavy hitters over a weighted stream of (key, weight)
+// updates, e.g. CPU ticks per process name per scan. Time is cut into
+// BucketSpan buckets, each holding a Space-Saving summary of at most
+// Counters keys, so memory is fixed no matter how many distinct keys pass
+// through. A query merges the buckets that overlap the window.
+//
+// Space-Saving never misses a key whose true weight in a bucket exceeds
+// bucketTotal / Counters. Reported weights may overcount by the summaries'
+// error and undercount by what fell out of buckets where the key was
+// evicted; Entry::error bounds both.
+class HeavyHitters {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::seconds BucketSpan{15};
+    static constexpr size_t BucketCount = 240; // one hour
+    static constexpr size_t Counters = 64;
+
+    struct Entry {
+        uint32_t key = 0;
+        uint64_t weight = 0;
+        uint64_t error = 0; // the true weight is within weight +/- error
+    };
+
+    HeavyHitters();
+
+    void Add(Clock::time_point now, uint32_t key, uint64_t weight);
+
+    // Heaviest k keys over the trailing window (rounded up to whole buckets,
+    // at most BucketCount of them), heaviest first. Returns the total weight
+    // seen in the window.
+    uint64_t Top(Clock::time_point now, std::chrono::seconds window, size_t k, std::vector<Entry>& out) const;
+
+private:
+    struct Bucket {
+        int64_t index = -1; // BucketSpan periods since the clock's epoch
+        uint32_t size = 0;
+        uint64_t total = 0;
+        std::array<uint32_t, Counters> keys{};
+        std::array<uint64_t, Counters> weights{};
+        std::array<uint64_t, Counters> errors{};
+    };
+
+    static int64_t BucketIndex(Clock::time_point t);
+
+    std::vector<Bucket> m_buckets; // BucketCount, ring indexed by bucket index
+};
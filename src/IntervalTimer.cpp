@@ -0,0 +1,79 @@
+#include "IntervalTimer.h"
+
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+IntervalTimer::IntervalTimer() {
+    m_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+}
+
+IntervalTimer::~IntervalTimer() {
+    if (m_fd >= 0) close(m_fd);
+}
+
+void IntervalTimer::SetRate(unsigned hz) {
+    if (m_fd < 0) return;
+    itimerspec spec{};
+    if (hz > 0) {
+        const long periodNs = 1000000000L / static_cast<long>(hz);
+        spec.it_interval.tv_sec = periodNs / 1000000000L;
+        spec.it_interval.tv_nsec = periodNs % 1000000000L;
+        spec.it_value = spec.it_interval;
+    }
+    timerfd_settime(m_fd, 0, &spec, nullptr);
+}
+
+uint64_t IntervalTimer::Wait() {
+    if (m_fd < 0) return 0;
+    while (!m_cancelled.load()) {
+        uint64_t expirations = 0;
+        if (read(m_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            return m_cancelled.load() ? 0 : expirations;
+        }
+    }
+    return 0;
+}
+
+void IntervalTimer::Cancel() {
+    m_cancelled.store(true);
+    // Fire now so a blocked read doesn't wait out a slow period
+    if (m_fd >= 0) {
+        itimerspec now{};
+        now.it_value.tv_nsec = 1;
+        timerfd_settime(m_fd, 0, &now, nullptr);
+    }
+}
+#else
+IntervalTimer::IntervalTimer() = default;
+IntervalTimer::~IntervalTimer() = default;
+
+void IntervalTimer::SetRate(unsigned hz) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_period = hz > 0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) / hz
+                      : std::chrono::steady_clock::duration{};
+    m_deadline = std::chrono::steady_clock::now() + m_period;
+}
+
+uint64_t IntervalTimer::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_period.count() == 0) {
+        m_cv.wait(lock, [&] { return m_cancelled.load(); });
+        return 0;
+    }
+    if (m_cv.wait_until(lock, m_deadline, [&] { return m_cancelled.load(); })) return 0;
+    // Every whole period that has passed counts, as with a timerfd
+    const auto late = std::chrono::steady_clock::now() - m_deadline;
+    const uint64_t periods = 1 + static_cast<uint64_t>(late / m_period);
+    m_deadline += m_period * static_cast<int64_t>(periods);
+    return periods;
+}
+
+void IntervalTimer::Cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled.store(true);
+    }
+    m_cv.notify_all();
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Periodic wakeups for a sampling thread. On Linux a CLOCK_MONOTONIC
+// timerfd, whose expiration count also reports ticks the thread was too busy
+// to take; elsewhere a steady_clock deadline that advances by whole periods,
+// so it doesn't drift either.
+class IntervalTimer {
+public:
+    IntervalTimer();
+    ~IntervalTimer();
+
+    IntervalTimer(const IntervalTimer&) = delete;
+    IntervalTimer& operator=(const IntervalTimer&) = delete;
+
+    // Starts ticking at hz from now; 0 disarms. Only from the waiting thread.
+    void SetRate(unsigned hz);
+
+    // Blocks until the next tick and returns the number of periods that
+    // elapsed since the previous one (more than 1 after an overrun), or 0
+    // once Cancel() was called
+    uint64_t Wait();
+
+    // Wakes Wait() for good; safe from any thread
+    void Cancel();
+
+private:
+    std::atomic<bool> m_cancelled{false};
+#if defined(__linux__)
+    int m_fd = -1;
+#else
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::chrono::steady_clock::duration m_period{};
+    std::chrono::steady_clock::time_point m_deadline{};
+#endif
+};
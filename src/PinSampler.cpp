@@ -0,0 +1,200 @@
+#include "PinSampler.h"
+
+#include <algorithm>
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+constexpr unsigned MaxRateHz = 100;
+} // namespace
+
+PinSampler::PinSampler(unsigned rateHz) : m_rateHz(std::clamp(rateHz, 1u, MaxRateHz)) {
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) m_ticksPerSecond = static_cast<double>(ticks);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize > 0) m_pageSize = static_cast<double>(pageSize);
+    // Pinned processes are few; the smallest share of the pool will do
+    m_reader.SetFdShare(FdShare::Pins);
+    m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    m_thread = std::thread(&PinSampler::Run, this);
+}
+
+PinSampler::~PinSampler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        // Fire the timer now so a blocked read doesn't wait out a slow period
+        if (m_timerFd >= 0) {
+            itimerspec now{};
+            now.it_value.tv_nsec = 1;
+            timerfd_settime(m_timerFd, 0, &now, nullptr);
+        }
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    if (m_timerFd >= 0) close(m_timerFd);
+}
+
+void PinSampler::SetTargets(const std::vector<PinTarget>& targets) {
+    std::vector<Series> next;
+    next.reserve(targets.size());
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const PinTarget& t : targets) {
+            auto it = std::find_if(m_series.begin(), m_series.end(),
+                                   [&](const Series& s) { return s.target.key == t.key; });
+            if (it != m_series.end()) {
+                it->target = t;
+                next.push_back(std::move(*it));
+            } else {
+                Series s;
+                s.target = t;
+                s.cpu.assign(HistoryLength, 0.0f);
+                s.rssMB.assign(HistoryLength, 0.0f);
+                next.push_back(std::move(s));
+            }
+        }
+        m_series.swap(next);
+    }
+    m_cv.notify_all();
+}
+
+void PinSampler::SetRate(unsigned hz) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        hz = std::clamp(hz, 1u, MaxRateHz);
+        if (hz == m_rateHz) return;
+        m_rateHz = hz;
+        m_rateChanged = true;
+    }
+    m_cv.notify_all();
+}
+
+unsigned PinSampler::Rate() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rateHz;
+}
+
+void PinSampler::Snapshot(std::vector<PinnedSeries>& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out.resize(m_series.size());
+    for (size_t i = 0; i < m_series.size(); ++i) {
+        const Series& s = m_series[i];
+        PinnedSeries& o = out[i];
+        o.key = s.target.key;
+        o.name = s.target.name;
+        o.pattern = s.target.pattern;
+        o.alive = s.alive;
+        o.cpuPercent = s.cpuPercent;
+        o.rssBytes = s.rssBytes;
+        // Unroll the rings, oldest first
+        const size_t start = (s.head + HistoryLength - s.count) % HistoryLength;
+        o.cpuHistory.resize(s.count);
+        o.rssMBHistory.resize(s.count);
+        for (size_t k = 0; k < s.count; ++k) {
+            o.cpuHistory[k] = s.cpu[(start + k) % HistoryLength];
+            o.rssMBHistory[k] = s.rssMB[(start + k) % HistoryLength];
+        }
+    }
+}
+
+void PinSampler::ArmTimer(unsigned hz) {
+    itimerspec spec{};
+    if (hz > 0) {
+        const long periodNs = 1000000000L / static_cast<long>(hz);
+        spec.it_interval.tv_sec = periodNs / 1000000000L;
+        spec.it_interval.tv_nsec = periodNs % 1000000000L;
+        spec.it_value = spec.it_interval;
+    }
+    timerfd_settime(m_timerFd, 0, &spec, nullptr);
+}
+
+void PinSampler::Run() {
+    if (m_timerFd < 0) return;
+    bool armed = false;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_series.empty()) {
+                // Nothing to sample: disarm and sleep until a pin or shutdown
+                if (armed) ArmTimer(0);
+                armed = false;
+                m_cv.wait(lock, [&] { return m_stop || !m_series.empty(); });
+            }
+            if (m_stop) return;
+            if (!armed || m_rateChanged) {
+                const double perWindow = m_rateHz * std::chrono::duration<double>(CpuWindow).count();
+                m_windowSamples = std::clamp<size_t>(static_cast<size_t>(perWindow), 1, MaxWindowSamples - 1) + 1;
+                // Window slots no longer line up with the new size
+                for (Series& s : m_series) s.windowHead = s.windowCount = 0;
+                ArmTimer(m_rateHz);
+                armed = true;
+                m_rateChanged = false;
+            }
+        }
+
+        uint64_t expirations = 0;
+        if (read(m_timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+        SampleAll();
+    }
+}
+
+void PinSampler::SampleAll() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_readKeys.clear();
+        for (const Series& s : m_series) m_readKeys.push_back(s.target.key);
+    }
+
+    // Read outside the lock; targets may change meanwhile and are matched by key
+    const auto now = std::chrono::steady_clock::now();
+    m_readRecords.resize(m_readKeys.size());
+    m_readOk.assign(m_readKeys.size(), 0);
+    for (size_t i = 0; i < m_readKeys.size(); ++i) {
+        const ProcessKey& key = m_readKeys[i];
+        ProcStatRecord& rec = m_readRecords[i];
+        m_readOk[i] = m_reader.ReadOne(key.pid, rec) && rec.startTime == key.startTime;
+        if (!m_readOk[i]) m_reader.Forget(key.pid);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_readKeys.size(); ++i) {
+        auto it = std::find_if(m_series.begin(), m_series.end(),
+                               [&](const Series& s) { return s.target.key == m_readKeys[i]; });
+        if (it != m_series.end()) Record(*it, m_readOk[i] ? &m_readRecords[i] : nullptr, now);
+    }
+}
+
+void PinSampler::Record(Series& s, const ProcStatRecord* rec, std::chrono::steady_clock::time_point now) {
+    if (!rec) {
+        // Exited; keep the history visible until the pin is dropped
+        s.alive = false;
+        return;
+    }
+    const unsigned long long ticks = rec->utime + rec->stime;
+    const size_t windowSize = m_windowSamples;
+    s.windowTime[s.windowHead] = now;
+    s.windowTicks[s.windowHead] = ticks;
+    s.windowHead = (s.windowHead + 1) % windowSize;
+    s.windowCount = std::min(s.windowCount + 1, windowSize);
+
+    // Oldest sample in the window vs. this one
+    float cpu = 0.0f;
+    if (s.windowCount > 1) {
+        const size_t oldest = (s.windowHead + windowSize - s.windowCount) % windowSize;
+        std::chrono::duration<double> span = now - s.windowTime[oldest];
+        const unsigned long long oldTicks = s.windowTicks[oldest];
+        if (span.count() > 0.0 && ticks >= oldTicks) {
+            cpu = static_cast<float>(static_cast<double>(ticks - oldTicks) * 100.0 / (span.count() * m_ticksPerSecond));
+        }
+    }
+
+    s.alive = true;
+    s.cpuPercent = cpu;
+    s.rssBytes = static_cast<unsigned long long>(static_cast<double>(rec->rssPages) * m_pageSize);
+    s.cpu[s.head] = cpu;
+    s.rssMB[s.head] = static_cast<float>(static_cast<double>(s.rssBytes) / (1024.0 * 1024.0));
+    s.head = (s.head + 1) % HistoryLength;
+    s.count = std::min(s.count + 1, HistoryLength);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "ProcessTable.h"
+
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include "ProcScanner.h"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// What the UI sees of one pinned process
+struct PinnedSeries {
+    ProcessKey key;
+    std::string name;
+    std::string pattern;      // the pin pattern that matched, empty for a pinned pid
+    bool alive = true;
+    float cpuPercent = 0.0f;  // latest sample
+    unsigned long long rssBytes = 0;
+    std::vector<float> cpuHistory;   // oldest first
+    std::vector<float> rssMBHistory; // oldest first
+};
+
+struct PinTarget {
+    ProcessKey key;
+    std::string name;
+    std::string pattern;
+};
+
+#if defined(__linux__)
+// High-frequency sampler for a handful of pinned processes. A timerfd wakes a
+// dedicated thread at the configured rate (up to 100 Hz) and each target's
+// /proc/<pid>/stat is re-read through a cached descriptor, one pread per
+// target per tick; the 1 Hz scan of everything else is unaffected. The thread
+// sleeps without a timer while nothing is pinned.
+//
+// The kernel reports CPU time in clock ticks (usually 10 ms), far coarser than
+// a 20 ms sample, so each CPU% sample is averaged over a trailing window of
+// CpuWindow instead of the last interval alone. RSS is exact per sample.
+class PinSampler {
+public:
+    static constexpr size_t HistoryLength = 1000;
+    static constexpr std::chrono::milliseconds CpuWindow{100};
+    static constexpr size_t MaxWindowSamples = 16;
+
+    explicit PinSampler(unsigned rateHz = 50);
+    ~PinSampler();
+
+    PinSampler(const PinSampler&) = delete;
+    PinSampler& operator=(const PinSampler&) = delete;
+
+    // Replaces the target set; history is kept for targets that stay
+    void SetTargets(const std::vector<PinTarget>& targets);
+
+    // Clamped to 1..100 Hz
+    void SetRate(unsigned hz);
+    unsigned Rate() const;
+
+    void Snapshot(std::vector<PinnedSeries>& out) const;
+
+private:
+    struct Series {
+        PinTarget target;
+        bool alive = true;
+        // Rings of HistoryLength; head is the next write position
+        std::vector<float> cpu;
+        std::vector<float> rssMB;
+        size_t head = 0;
+        size_t count = 0;
+        unsigned long long rssBytes = 0;
+        float cpuPercent = 0.0f;
+        // Recent (time, cpu ticks) pairs spanning the CPU window
+        std::array<std::chrono::steady_clock::time_point, MaxWindowSamples> windowTime{};
+        std::array<unsigned long long, MaxWindowSamples> windowTicks{};
+        size_t windowHead = 0;
+        size_t windowCount = 0;
+    };
+
+    void Run();
+    void ArmTimer(unsigned hz);
+    void SampleAll();
+    void Record(Series& s, const ProcStatRecord* rec, std::chrono::steady_clock::time_point now);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<Series> m_series;
+    unsigned m_rateHz;
+    bool m_rateChanged = true;
+    bool m_stop = false;
+
+    // Sampler thread only
+    std::vector<ProcessKey> m_readKeys;
+    std::vector<ProcStatRecord> m_readRecords;
+    std::vector<uint8_t> m_readOk;
+    size_t m_windowSamples = 2;
+    int m_timerFd = -1;
+    double m_ticksPerSecond = 100.0;
+    double m_pageSize = 4096.0;
+    ProcScanner m_reader{"/proc", 1, false};
+    std::thread m_thread;
+};
+#endif
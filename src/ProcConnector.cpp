@@ -0,0 +1,115 @@
+#include "ProcConnector.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include <linux/netlink.h>
+
+namespace {
+constexpr int ReceiveBufferBytes = 4 * 1024 * 1024;
+
+bool SendMcastOp(int fd, proc_cn_mcast_op op) {
+    alignas(nlmsghdr) char buf[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))]{};
+    auto* nl = reinterpret_cast<nlmsghdr*>(buf);
+    auto* cn = static_cast<cn_msg*>(NLMSG_DATA(nl));
+
+    nl->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(op));
+    nl->nlmsg_type = NLMSG_DONE;
+    nl->nlmsg_pid = static_cast<__u32>(getpid());
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(op);
+    std::memcpy(cn->data, &op, sizeof(op));
+
+    return send(fd, nl, nl->nlmsg_len, 0) == static_cast<ssize_t>(nl->nlmsg_len);
+}
+} // namespace
+
+ProcConnector::~ProcConnector() {
+    Close();
+}
+
+bool ProcConnector::Open() {
+    if (m_fd >= 0) return true;
+
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) return false;
+
+    // Bursts of compiler forks can outrun a frame; give the kernel room to queue them
+    int rcvbuf = ReceiveBufferBytes;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        !SendMcastOp(fd, PROC_CN_MCAST_LISTEN)) {
+        close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    return true;
+}
+
+void ProcConnector::Close() {
+    if (m_fd < 0) return;
+    SendMcastOp(m_fd, PROC_CN_MCAST_IGNORE);
+    close(m_fd);
+    m_fd = -1;
+}
+
+bool ProcConnector::Poll(std::vector<Event>& out) {
+    if (m_fd < 0) return true;
+
+    alignas(nlmsghdr) char buf[16 * 1024];
+    for (;;) {
+        ssize_t n = recv(m_fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno != ENOBUFS; // EAGAIN: queue drained
+        }
+        if (n == 0) return true;
+
+        int len = static_cast<int>(n);
+        for (auto* nl = reinterpret_cast<nlmsghdr*>(buf); NLMSG_OK(nl, len); nl = NLMSG_NEXT(nl, len)) {
+            if (nl->nlmsg_type == NLMSG_ERROR || nl->nlmsg_type == NLMSG_NOOP) continue;
+
+            auto* cn = static_cast<cn_msg*>(NLMSG_DATA(nl));
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) continue;
+            auto* ev = reinterpret_cast<proc_event*>(cn->data);
+
+            // Thread-level events have pid != tgid; only whole processes matter here
+            Event e;
+            switch (ev->what) {
+            case proc_event::PROC_EVENT_FORK:
+                if (ev->event_data.fork.child_pid != ev->event_data.fork.child_tgid) continue;
+                e.type = EventType::Fork;
+                e.pid = ev->event_data.fork.child_tgid;
+                e.parentPid = ev->event_data.fork.parent_tgid;
+                break;
+            case proc_event::PROC_EVENT_EXEC:
+                e.type = EventType::Exec;
+                e.pid = ev->event_data.exec.process_tgid;
+                break;
+            case proc_event::PROC_EVENT_COMM:
+                if (ev->event_data.comm.process_pid != ev->event_data.comm.process_tgid) continue;
+                e.type = EventType::Comm;
+                e.pid = ev->event_data.comm.process_tgid;
+                break;
+            case proc_event::PROC_EVENT_EXIT:
+                if (ev->event_data.exit.process_pid != ev->event_data.exit.process_tgid) continue;
+                e.type = EventType::Exit;
+                e.pid = ev->event_data.exit.process_tgid;
+                break;
+            default:
+                continue;
+            }
+            out.push_back(e);
+        }
+    }
+}
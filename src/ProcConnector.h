@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+// Subscriber for the kernel proc connector (NETLINK_CONNECTOR / CN_IDX_PROC).
+// Delivers fork/exec/comm/exit notifications for whole processes, so tasks that
+// live for a few milliseconds are seen even if no /proc scan ever catches them.
+// Subscribing requires CAP_NET_ADMIN; Open() fails cleanly without it.
+class ProcConnector {
+public:
+    enum class EventType { Fork, Exec, Comm, Exit };
+
+    struct Event {
+        EventType type = EventType::Fork;
+        int pid = 0;
+        int parentPid = 0; // Fork only
+    };
+
+    ProcConnector() = default;
+    ~ProcConnector();
+
+    ProcConnector(const ProcConnector&) = delete;
+    ProcConnector& operator=(const ProcConnector&) = delete;
+
+    bool Open();
+    void Close();
+    bool IsOpen() const { return m_fd >= 0; }
+
+    // Appends all queued events to out without blocking. Returns false if the
+    // kernel dropped events because the socket buffer overflowed; the caller
+    // must then reconcile against /proc.
+    bool Poll(std::vector<Event>& out);
+
+private:
+    int m_fd = -1;
+};
@@ -0,0 +1,573 @@
+#include "ProcScanner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+namespace {
+// Layout returned by getdents64 (not exported by glibc headers)
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+constexpr size_t DirentBufferSize = 64 * 1024;
+constexpr size_t StatBufferSize = 1024;
+constexpr size_t IoBufferSize = 256;
+constexpr unsigned MaxAutoWorkers = 4;
+// Descriptors left for everything else the HUD opens (GL, curl, /proc files)
+constexpr size_t FdHeadroom = 256;
+
+bool ParsePidName(const char* name, int& pid) {
+    if (*name == '\0') return false;
+    int v = 0;
+    for (; *name; ++name) {
+        if (*name < '0' || *name > '9') return false;
+        v = v * 10 + (*name - '0');
+    }
+    pid = v;
+    return true;
+}
+
+// Writes "<pid><suffix>" (e.g. "123/stat"), relative to the proc root
+bool FormatPidPath(int pid, const char* suffix, char* buf, size_t size) {
+    size_t suffixLen = std::strlen(suffix) + 1;
+    if (size <= suffixLen) return false;
+    auto [end, ec] = std::to_chars(buf, buf + size - suffixLen, pid);
+    if (ec != std::errc()) return false;
+    std::memcpy(end, suffix, suffixLen);
+    return true;
+}
+
+bool FormatStatPath(int pid, char* buf, size_t size) {
+    return FormatPidPath(pid, "/stat", buf, size);
+}
+
+// Only these mean the process is gone; anything else (EMFILE, ENFILE, ...)
+// says nothing about whether it still runs
+bool ProcessExited(int err) {
+    return err == ENOENT || err == ESRCH;
+}
+
+bool OutOfFds(int err) {
+    return err == EMFILE || err == ENFILE;
+}
+
+size_t FdSoftLimit() {
+    rlimit lim{};
+    if (getrlimit(RLIMIT_NOFILE, &lim) != 0 || lim.rlim_cur == RLIM_INFINITY) return 65536;
+    return static_cast<size_t>(lim.rlim_cur);
+}
+} // namespace
+
+ProcScanner::ProcScanner(const char* root, unsigned workers, bool useUring)
+    : m_root(root), m_direntBuf(DirentBufferSize) {
+    if (workers == 0) {
+        workers = std::clamp(std::thread::hardware_concurrency(), 1u, MaxAutoWorkers);
+    }
+    if (useUring) {
+        for (unsigned i = 0; i < workers; ++i) {
+            m_rings.push_back(std::make_unique<UringReader>(StatBufferSize));
+            if (!m_rings.back()->IsAvailable()) {
+                m_rings.clear();
+                break;
+            }
+        }
+    }
+    SetFdBudget(FdPoolShare(m_fdShare));
+    // The calling thread always takes shards too
+    for (unsigned i = 1; i < workers; ++i) {
+        m_workers.emplace_back(&ProcScanner::WorkerLoop, this, i);
+    }
+}
+
+ProcScanner::~ProcScanner() {
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_stop = true;
+    }
+    m_workCv.notify_all();
+    for (auto& t : m_workers) {
+        t.join();
+    }
+    for (const auto& [pid, cached] : m_fdCache) {
+        close(cached.fd);
+        if (cached.ioFd >= 0) close(cached.ioFd);
+    }
+    if (m_rootFd >= 0) {
+        close(m_rootFd);
+    }
+}
+
+bool ProcScanner::Scan(std::vector<ProcStatRecord>& out) {
+    out.clear();
+    m_syscalls = 0;
+    m_lastError = 0;
+    if (!ListPids()) return false;
+    AttachCachedFds();
+
+    // Fixed-size shards claimed dynamically, so one slow shard doesn't stall the rest
+    size_t count = m_entries.size();
+    size_t shardSize = count < ParallelThreshold || m_workers.empty() ? count : ShardSize;
+    size_t shardCount = shardSize == 0 ? 0 : (count + shardSize - 1) / shardSize;
+    if (m_shards.size() < shardCount) m_shards.resize(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        m_shards[i].begin = i * shardSize;
+        m_shards[i].end = std::min(count, (i + 1) * shardSize);
+    }
+    m_shards.resize(shardCount);
+
+    if (shardCount == 1) {
+        ReadShard(m_shards[0], m_rings.empty() ? nullptr : m_rings[0].get());
+    } else if (shardCount > 1) {
+        RunShards();
+    }
+
+    out.reserve(count);
+    for (const Shard& shard : m_shards) {
+        out.insert(out.end(), shard.records.begin(), shard.records.end());
+        m_syscalls += shard.syscalls;
+    }
+    UpdateFdCache();
+    for (const PidEntry& e : m_entries) {
+        if (e.error != 0) {
+            m_lastError = e.error;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProcScanner::ReadOne(int pid, ProcStatRecord& rec) {
+    m_syscalls = 0;
+    m_lastError = 0;
+    if (m_rootFd < 0 && !OpenRoot()) return false;
+
+    PidEntry e;
+    e.pid = pid;
+    auto it = m_fdCache.find(pid);
+    if (it != m_fdCache.end()) {
+        e.cachedFd = it->second.fd;
+        e.cachedIoFd = it->second.ioFd;
+        it->second.hits += HitWeight;
+    } else {
+        e.admit = m_openFds + FdsPerPid() <= m_fdBudget;
+        // A full cache: count the read toward the pid's next chance at a slot
+        auto c = m_candidates.find(pid);
+        if (!e.admit && c != m_candidates.end()) c->second.hits += HitWeight;
+    }
+    bool ok = ReadEntry(e, rec, m_syscalls);
+    Settle(e);
+    EvictOverBudget();
+    m_lastError = e.error;
+    return ok;
+}
+
+size_t ProcScanner::ActiveRingCount() const {
+    return static_cast<size_t>(std::count_if(m_rings.begin(), m_rings.end(),
+                                             [](const auto& ring) { return ring->IsAvailable(); }));
+}
+
+void ProcScanner::Adopt(int pid, int fd, int ioFd) {
+    // A candidate keeps the count that won it the slot, so it isn't the
+    // coldest entry again on the next scan
+    uint32_t hits = HitWeight;
+    auto c = m_candidates.find(pid);
+    if (c != m_candidates.end()) {
+        hits = c->second.hits;
+        m_candidates.erase(c);
+    }
+    m_fdLru.push_front(pid);
+    m_fdCache[pid] = CachedFd{fd, ioFd, hits, m_fdLru.begin()};
+    m_openFds += ioFd >= 0 ? 2 : 1;
+}
+
+void ProcScanner::Forget(int pid) {
+    auto it = m_fdCache.find(pid);
+    if (it == m_fdCache.end()) return;
+    close(it->second.fd);
+    --m_openFds;
+    if (it->second.ioFd >= 0) {
+        close(it->second.ioFd);
+        --m_openFds;
+    }
+    m_fdLru.erase(it->second.lru);
+    m_fdCache.erase(it);
+}
+
+void ProcScanner::SetFdBudget(size_t budget) {
+    m_fdBudget = std::min(budget, FdPoolShare(m_fdShare));
+    EvictOverBudget();
+}
+
+void ProcScanner::SetFdShare(FdShare share) {
+    m_fdShare = share;
+    SetFdBudget(FdPoolShare(share));
+}
+
+size_t ProcScanner::FdPoolShare(FdShare share) {
+    size_t limit = FdSoftLimit();
+    size_t pool = limit > FdHeadroom ? limit - FdHeadroom : 0;
+    switch (share) {
+    case FdShare::Processes: return pool / 2;
+    case FdShare::Threads: return pool / 4;
+    case FdShare::Cgroups: return pool / 8;
+    case FdShare::Pins: return pool / 16;
+    }
+    return 0;
+}
+
+bool ProcScanner::OpenRoot() {
+    m_rootFd = open(m_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    ++m_syscalls;
+    if (m_rootFd < 0) m_lastError = errno;
+    return m_rootFd >= 0;
+}
+
+bool ProcScanner::ListPids() {
+    m_entries.clear();
+    if (m_rootFd < 0) {
+        if (!OpenRoot()) return false;
+    } else {
+        // Rewind the kept directory descriptor instead of reopening /proc
+        lseek(m_rootFd, 0, SEEK_SET);
+        ++m_syscalls;
+    }
+
+    for (;;) {
+        long n = syscall(SYS_getdents64, m_rootFd, m_direntBuf.data(), m_direntBuf.size());
+        ++m_syscalls;
+        if (n <= 0) break;
+
+        for (long off = 0; off < n;) {
+            auto* d = reinterpret_cast<LinuxDirent64*>(m_direntBuf.data() + off);
+            off += d->d_reclen;
+            if (d->d_type != DT_DIR && d->d_type != DT_UNKNOWN) continue;
+            PidEntry e;
+            if (ParsePidName(d->d_name, e.pid)) {
+                m_entries.push_back(e);
+            }
+        }
+    }
+    return true;
+}
+
+void ProcScanner::AttachCachedFds() {
+    // Uncached pids may keep their descriptor while the budget has room;
+    // the ones still around next scan are the long-lived ones. The rest
+    // compete for the slots of colder cached pids.
+    ++m_scanCount;
+    size_t room = m_fdBudget > m_openFds ? (m_fdBudget - m_openFds) / FdsPerPid() : 0;
+    bool waiting = false;
+    for (PidEntry& e : m_entries) {
+        auto it = m_fdCache.find(e.pid);
+        if (it != m_fdCache.end()) {
+            e.cachedFd = it->second.fd;
+            e.cachedIoFd = it->second.ioFd;
+            it->second.hits = Decay(it->second.hits) + HitWeight;
+        } else if (room > 0) {
+            e.admit = true;
+            --room;
+        } else if (m_fdBudget > 0) {
+            Candidate& c = m_candidates[e.pid];
+            c.hits = Decay(c.hits) + HitWeight;
+            c.scan = m_scanCount;
+            c.chosen = false;
+            waiting = true;
+        }
+    }
+    // Exited pids, and ones that got a slot meanwhile, stop competing
+    std::erase_if(m_candidates, [&](const auto& kv) { return kv.second.scan != m_scanCount; });
+    if (!waiting || !ReplaceColdFds()) return;
+
+    for (PidEntry& e : m_entries) {
+        if (e.cachedFd >= 0) {
+            if (m_fdCache.find(e.pid) == m_fdCache.end()) {
+                // Just evicted; read it the plain way this time
+                e.cachedFd = -1;
+                e.cachedIoFd = -1;
+            }
+            continue;
+        }
+        auto c = m_candidates.find(e.pid);
+        if (c != m_candidates.end() && c->second.chosen) e.admit = true;
+    }
+}
+
+bool ProcScanner::ReplaceColdFds() {
+    // The hottest candidates against the coldest cached pids, pairwise, for
+    // as long as the candidate is strictly hotter
+    const size_t k = std::min(m_candidates.size(), m_fdCache.size());
+    if (k == 0) return false;
+    m_hottest.clear();
+    for (const auto& [pid, c] : m_candidates) m_hottest.emplace_back(c.hits, pid);
+    std::partial_sort(m_hottest.begin(), m_hottest.begin() + static_cast<std::ptrdiff_t>(k), m_hottest.end(),
+                      std::greater<>());
+    m_coldest.clear();
+    for (const auto& [pid, cached] : m_fdCache) m_coldest.emplace_back(cached.hits, pid);
+    std::partial_sort(m_coldest.begin(), m_coldest.begin() + static_cast<std::ptrdiff_t>(k), m_coldest.end());
+
+    size_t replaced = 0;
+    for (; replaced < k && m_hottest[replaced].first > m_coldest[replaced].first; ++replaced) {
+        Evict(m_coldest[replaced].second);
+        m_candidates[m_hottest[replaced].second].chosen = true;
+    }
+    return replaced > 0;
+}
+
+void ProcScanner::Settle(PidEntry& e) {
+    if (e.stale) {
+        Forget(e.pid);
+        ++m_syscalls;
+    }
+    if (e.keptFd >= 0) {
+        Adopt(e.pid, e.keptFd, e.keptIoFd);
+    } else if (e.cachedFd >= 0 && !e.stale) {
+        auto it = m_fdCache.find(e.pid);
+        m_fdLru.splice(m_fdLru.begin(), m_fdLru, it->second.lru);
+        // Only opened when the cache had none, so nothing is overwritten
+        if (e.keptIoFd != -1) {
+            it->second.ioFd = e.keptIoFd;
+            if (e.keptIoFd >= 0) ++m_openFds;
+        }
+    } else if (e.keptIoFd >= 0) {
+        // The stat read failed, so there's no cache entry to hang it on
+        close(e.keptIoFd);
+        ++m_syscalls;
+    }
+}
+
+void ProcScanner::UpdateFdCache() {
+    for (PidEntry& e : m_entries) {
+        Settle(e);
+    }
+    EvictOverBudget();
+}
+
+void ProcScanner::EvictOverBudget() {
+    while (m_openFds > m_fdBudget) {
+        Evict(m_fdLru.back());
+    }
+}
+
+void ProcScanner::Evict(int pid) {
+    const size_t before = m_openFds;
+    Forget(pid);
+    m_evictedFds += before - m_openFds;
+}
+
+bool ProcScanner::ReadEntry(PidEntry& e, ProcStatRecord& rec, size_t& syscalls) const {
+    if (e.cachedFd >= 0) {
+        char buf[StatBufferSize];
+        ssize_t n = pread(e.cachedFd, buf, sizeof(buf), 0);
+        ++syscalls;
+        if (n > 0) {
+            if (!ParseProcStat(buf, static_cast<size_t>(n), rec, m_parseProcessor)) return false;
+            if (m_readIo) ReadIo(e, rec, syscalls);
+            return true;
+        }
+        // ESRCH: the process is gone, and the pid may already belong to a new one
+        e.stale = true;
+    }
+    if (!ReadFresh(e, rec, syscalls)) return false;
+    if (m_readIo) ReadIo(e, rec, syscalls);
+    return true;
+}
+
+bool ProcScanner::ReadFresh(PidEntry& e, ProcStatRecord& rec, size_t& syscalls) const {
+    char path[32];
+    if (!FormatStatPath(e.pid, path, sizeof(path))) return false;
+
+    int fd = openat(m_rootFd, path, O_RDONLY | O_CLOEXEC);
+    ++syscalls;
+    if (fd < 0) {
+        // ENOENT: the process exited between getdents and open
+        if (!ProcessExited(errno)) e.error = errno;
+        return false;
+    }
+
+    char buf[StatBufferSize];
+    ssize_t n = read(fd, buf, sizeof(buf));
+    ++syscalls;
+    if (n > 0 && (e.admit || e.stale)) {
+        e.keptFd = fd;
+    } else {
+        close(fd);
+        ++syscalls;
+    }
+    if (n <= 0) return false;
+
+    return ParseProcStat(buf, static_cast<size_t>(n), rec, m_parseProcessor);
+}
+
+bool ProcScanner::ReadIo(PidEntry& e, ProcStatRecord& rec, size_t& syscalls) const {
+    char buf[IoBufferSize];
+    if (e.cachedIoFd >= 0 && !e.stale) {
+        ssize_t n = pread(e.cachedIoFd, buf, sizeof(buf), 0);
+        ++syscalls;
+        return n > 0 && ParseProcIo(buf, static_cast<size_t>(n), rec);
+    }
+    if (e.cachedIoFd == IoDenied && !e.stale) return false;
+
+    char path[32];
+    if (!FormatPidPath(e.pid, "/io", path, sizeof(path))) return false;
+    int fd = openat(m_rootFd, path, O_RDONLY | O_CLOEXEC);
+    ++syscalls;
+    if (fd < 0) {
+        // EACCES for other users' processes; an exited one gets cleaned up with its stat fd.
+        // Running out of descriptors denies nothing, so that pid is retried.
+        if (!OutOfFds(errno)) e.keptIoFd = IoDenied;
+        return false;
+    }
+
+    ssize_t n = read(fd, buf, sizeof(buf));
+    ++syscalls;
+    // Kept only alongside a stat descriptor that is cached or about to be
+    if (n > 0 && (e.keptFd >= 0 || (e.cachedFd >= 0 && !e.stale))) {
+        e.keptIoFd = fd;
+    } else {
+        close(fd);
+        ++syscalls;
+    }
+    return n > 0 && ParseProcIo(buf, static_cast<size_t>(n), rec);
+}
+
+void ProcScanner::ReadShard(Shard& shard, UringReader* ring) {
+    shard.records.clear();
+    shard.syscalls = 0;
+    size_t i = shard.begin;
+
+    if (ring && ring->IsAvailable()) {
+        char path[32];
+        int slots[UringReader::BatchSize];
+        int ioSlots[UringReader::BatchSize];
+        size_t perPid = FdsPerPid();
+        while (i < shard.end) {
+            ring->Reset();
+            size_t batchBegin = i;
+            for (; i < shard.end && ring->Pending() + perPid <= UringReader::BatchSize; ++i) {
+                PidEntry& e = m_entries[i];
+                int& slot = slots[i - batchBegin];
+                int& ioSlot = ioSlots[i - batchBegin];
+                if (e.cachedFd >= 0) {
+                    slot = ring->AddFd(e.cachedFd);
+                } else {
+                    slot = FormatStatPath(e.pid, path, sizeof(path)) ? ring->Add(m_rootFd, path, e.admit) : -1;
+                }
+                ioSlot = -1;
+                if (!m_readIo || e.cachedIoFd == IoDenied) continue;
+                if (e.cachedIoFd >= 0) {
+                    ioSlot = ring->AddFd(e.cachedIoFd);
+                } else if (FormatPidPath(e.pid, "/io", path, sizeof(path))) {
+                    ioSlot = ring->Add(m_rootFd, path, e.admit || e.cachedFd >= 0);
+                }
+            }
+            if (!ring->Submit(shard.syscalls)) {
+                // Ring broke mid-scan: redo this batch and the rest the plain way
+                i = batchBegin;
+                break;
+            }
+
+            for (size_t k = batchBegin; k < i; ++k) {
+                int slot = slots[k - batchBegin];
+                PidEntry& e = m_entries[k];
+                // A freshly opened io descriptor; Settle() closes it if the stat one isn't kept
+                int ioSlot = ioSlots[k - batchBegin];
+                int ioFd = ioSlot >= 0 && e.cachedIoFd < 0 ? ring->Fd(ioSlot) : -1;
+                if (slot < 0) {
+                    e.keptIoFd = ioFd;
+                    continue;
+                }
+                ProcStatRecord rec;
+                std::string_view data = ring->Result(slot);
+                if (e.cachedFd < 0) e.keptFd = ring->Fd(slot);
+
+                if (data.empty() && e.cachedFd >= 0) {
+                    // Pid reused or gone: whatever the io slot read is no use
+                    if (ioFd >= 0) {
+                        close(ioFd);
+                        ++shard.syscalls;
+                    }
+                    e.stale = true;
+                    if (ReadFresh(e, rec, shard.syscalls)) {
+                        if (m_readIo) ReadIo(e, rec, shard.syscalls);
+                        shard.records.push_back(rec);
+                    }
+                    continue;
+                }
+                if (data.empty() || !ParseProcStat(data.data(), data.size(), rec, m_parseProcessor)) {
+                    int err = ring->Error(slot);
+                    if (err != 0 && !ProcessExited(err)) e.error = err;
+                    e.keptIoFd = ioFd;
+                    continue;
+                }
+                if (ioSlot >= 0) {
+                    std::string_view io = ring->Result(ioSlot);
+                    if (e.cachedIoFd < 0) {
+                        // Running out of descriptors denies nothing; that pid is retried
+                        e.keptIoFd = !io.empty() ? ioFd : OutOfFds(ring->Error(ioSlot)) ? -1 : IoDenied;
+                    }
+                    if (!io.empty()) ParseProcIo(io.data(), io.size(), rec);
+                }
+                shard.records.push_back(rec);
+            }
+        }
+    }
+
+    for (; i < shard.end; ++i) {
+        ProcStatRecord rec;
+        if (ReadEntry(m_entries[i], rec, shard.syscalls)) {
+            shard.records.push_back(rec);
+        }
+    }
+}
+
+void ProcScanner::RunShards() {
+    m_nextShard.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        ++m_jobSeq;
+        m_busyWorkers = static_cast<unsigned>(m_workers.size());
+    }
+    m_workCv.notify_all();
+
+    UringReader* ring = m_rings.empty() ? nullptr : m_rings[0].get();
+    for (size_t i; (i = m_nextShard.fetch_add(1, std::memory_order_relaxed)) < m_shards.size();) {
+        ReadShard(m_shards[i], ring);
+    }
+
+    std::unique_lock<std::mutex> lock(m_poolMutex);
+    m_doneCv.wait(lock, [this] { return m_busyWorkers == 0; });
+}
+
+void ProcScanner::WorkerLoop(unsigned index) {
+    UringReader* ring = m_rings.empty() ? nullptr : m_rings[index].get();
+    uint64_t seenJob = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_poolMutex);
+            m_workCv.wait(lock, [&] { return m_stop || m_jobSeq != seenJob; });
+            if (m_stop) return;
+            seenJob = m_jobSeq;
+        }
+
+        for (size_t i; (i = m_nextShard.fetch_add(1, std::memory_order_relaxed)) < m_shards.size();) {
+            ReadShard(m_shards[i], ring);
+        }
+
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        if (--m_busyWorkers == 0) m_doneCv.notify_one();
+    }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "ProcStat.h"
+#include "UringReader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Native Linux process enumerator. Walks /proc with getdents64 and reads each
+// /proc/<pid>/stat with plain open/read/close: no fork, no iostreams.
+//
+// On hosts with many tasks the pid list is cut into fixed-size shards that a
+// small worker pool reads in parallel. Each shard writes only to its own
+// output buffer, so workers never share a lock; the buffers are concatenated
+// in pid order once every shard is done.
+//
+// Where io_uring is available each scanning thread owns a ring and reads its
+// shard in batches (see UringReader); otherwise it uses open/read/close.
+//
+// Stat descriptors of long-lived processes stay open in a bounded cache and
+// are refreshed with a single pread at offset 0. A descriptor whose process
+// has exited fails with ESRCH and is dropped. Every pid carries a hit count
+// that decays each scan; once the cache is full, an uncached pid that has
+// been read more often than the coldest cached one takes its place. Equally
+// hot pids aren't swapped, since that would only add open/close calls.
+//
+// With SetReadIo(true) the same pass also reads /proc/<pid>/io, and its
+// descriptor is cached next to the stat one. Other users' processes refuse
+// io without root; a cached pid remembers that and isn't retried.
+//
+// Every descriptor cache in the process (this scanner's, the thread and pin
+// samplers', the cgroup collector's) draws on one pool, RLIMIT_NOFILE less
+// headroom for everything else, and each gets a fixed share of it, so their
+// budgets can't add up past the limit.
+enum class FdShare {
+    Processes, // half the pool
+    Threads,   // a quarter
+    Cgroups,   // an eighth
+    Pins,      // a sixteenth
+};
+
+class ProcScanner {
+public:
+    // workers == 0 picks a count from the hardware concurrency
+    explicit ProcScanner(const char* root = "/proc", unsigned workers = 0, bool useUring = true);
+    ~ProcScanner();
+
+    ProcScanner(const ProcScanner&) = delete;
+    ProcScanner& operator=(const ProcScanner&) = delete;
+
+    // Replaces the contents of out with one record per live process.
+    // Returns false if the proc root can't be opened, or if a process
+    // couldn't be read for a reason other than having exited (EMFILE, ENFILE):
+    // out then misses live processes and mustn't be taken as the full list.
+    bool Scan(std::vector<ProcStatRecord>& out);
+
+    // Reads a single process, keeping its descriptor cached while the budget
+    // has room. Returns false if it no longer exists, or couldn't be read
+    // (see LastError()).
+    bool ReadOne(int pid, ProcStatRecord& rec);
+
+    // errno behind the last failed Scan() or ReadOne(), other than a process
+    // exiting; 0 if it only saw exits
+    int LastError() const { return m_lastError; }
+
+    // Closes the cached descriptor of an exited process
+    void Forget(int pid);
+
+    // Maximum number of cached stat and io descriptors. Clamped to this
+    // scanner's share of the pool; 0 disables the cache.
+    void SetFdBudget(size_t budget);
+    // Moves the scanner to another share (Processes by default) and sets
+    // the budget to all of it
+    void SetFdShare(FdShare share);
+    // Descriptors one share may keep cached
+    static size_t FdPoolShare(FdShare share);
+    size_t FdBudget() const { return m_fdBudget; }
+    size_t CachedFdCount() const { return m_openFds; }
+
+    // Descriptors closed to make room (a colder pid replaced, or the budget
+    // shrank), as opposed to ones dropped because their process exited.
+    // Cumulative.
+    size_t EvictedFdCount() const { return m_evictedFds; }
+
+    // Also parse the CPU each task last ran on (ProcStatRecord::processor)
+    void SetParseProcessor(bool on) { m_parseProcessor = on; }
+
+    // Also read /proc/<pid>/io into the record's io fields
+    void SetReadIo(bool on) { m_readIo = on; }
+
+    // Number of syscalls issued by the last Scan() or ReadOne()
+    size_t LastSyscallCount() const { return m_syscalls; }
+
+    // Total threads used by Scan(), including the calling thread
+    unsigned WorkerCount() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    // Scanning threads whose io_uring ring is still live. A ring that fails
+    // mid-scan is torn down and its thread reads with plain syscalls from
+    // then on, so this can drop below WorkerCount().
+    size_t ActiveRingCount() const;
+
+    // True while every scanning thread reads through io_uring
+    bool UsingUring() const { return !m_rings.empty() && ActiveRingCount() == m_rings.size(); }
+
+    // Below this many pids a scan stays on the calling thread
+    static constexpr size_t ParallelThreshold = 2048;
+    static constexpr size_t ShardSize = 512;
+
+private:
+    // Per-pid scan state. Each entry is touched by exactly one shard, so the
+    // descriptor cache is only consulted and updated on the calling thread.
+    struct PidEntry {
+        int pid = 0;
+        int cachedFd = -1;  // from the descriptor cache, or -1
+        int keptFd = -1;    // opened this scan and handed to the cache
+        int cachedIoFd = -1; // io descriptor from the cache, -1, or IoDenied
+        int keptIoFd = -1;   // io descriptor (or IoDenied) for the cache
+        bool admit = false; // may keep the descriptor it opens
+        bool stale = false; // cachedFd belongs to an exited process
+        int error = 0;      // errno of an open that failed for another reason
+    };
+
+    struct Shard {
+        size_t begin = 0;
+        size_t end = 0;
+        size_t syscalls = 0;
+        std::vector<ProcStatRecord> records;
+    };
+
+    // Marks a pid whose io file can't be opened by this user
+    static constexpr int IoDenied = -2;
+
+    struct CachedFd {
+        int fd = -1;
+        int ioFd = -1; // or IoDenied
+        uint32_t hits = 0; // decayed read count, see Touch()
+        std::list<int>::iterator lru;
+    };
+
+    // An uncached pid waiting for a cache slot
+    struct Candidate {
+        uint32_t hits = 0;
+        uint64_t scan = 0; // last scan that saw it
+        bool chosen = false;
+    };
+
+    // Reads add HitWeight; each scan first keeps 7/8 of the previous count,
+    // so a pid read once per scan settles at 8 * HitWeight
+    static constexpr uint32_t HitWeight = 8;
+    static uint32_t Decay(uint32_t hits) { return hits - hits / 8; }
+
+    bool OpenRoot();
+    bool ListPids();
+    void AttachCachedFds();
+    bool ReplaceColdFds();
+    void Adopt(int pid, int fd, int ioFd);
+    void Settle(PidEntry& e);
+    void UpdateFdCache();
+    void EvictOverBudget();
+    void Evict(int pid);
+    size_t FdsPerPid() const { return m_readIo ? 2 : 1; }
+    bool ReadEntry(PidEntry& e, ProcStatRecord& rec, size_t& syscalls) const;
+    bool ReadFresh(PidEntry& e, ProcStatRecord& rec, size_t& syscalls) const;
+    bool ReadIo(PidEntry& e, ProcStatRecord& rec, size_t& syscalls) const;
+    void ReadShard(Shard& shard, UringReader* ring);
+    void RunShards();
+    void WorkerLoop(unsigned index);
+
+    std::string m_root;
+    int m_rootFd = -1;
+    std::vector<char> m_direntBuf;
+    std::vector<PidEntry> m_entries;
+    std::vector<Shard> m_shards;
+    size_t m_syscalls = 0;
+    int m_lastError = 0;
+    bool m_parseProcessor = false;
+    bool m_readIo = false;
+
+    // Descriptor cache; m_fdLru is most recently used first
+    std::unordered_map<int, CachedFd> m_fdCache;
+    std::list<int> m_fdLru;
+    size_t m_fdBudget = 0;
+    FdShare m_fdShare = FdShare::Processes;
+    size_t m_openFds = 0; // descriptors held by m_fdCache
+    size_t m_evictedFds = 0;
+    uint64_t m_scanCount = 0;
+    std::unordered_map<int, Candidate> m_candidates; // only while the cache is full
+    std::vector<std::pair<uint32_t, int>> m_coldest;  // ReplaceColdFds() scratch: (hits, pid)
+    std::vector<std::pair<uint32_t, int>> m_hottest;
+
+    // One ring per scanning thread (index 0 is the caller); empty without io_uring
+    std::vector<std::unique_ptr<UringReader>> m_rings;
+
+    // Worker pool; shards are claimed through m_nextShard
+    std::vector<std::thread> m_workers;
+    std::mutex m_poolMutex;
+    std::condition_variable m_workCv;
+    std::condition_variable m_doneCv;
+    uint64_t m_jobSeq = 0;
+    unsigned m_busyWorkers = 0;
+    bool m_stop = false;
+    std::atomic<size_t> m_nextShard{0};
+};
@@ -0,0 +1,123 @@
+#include "ProcStat.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace {
+// Field numbers as documented in proc(5)
+constexpr int FieldState = 3;
+constexpr int FieldPpid = 4;
+constexpr int FieldUtime = 14;
+constexpr int FieldStime = 15;
+constexpr int FieldNumThreads = 20;
+constexpr int FieldStartTime = 22;
+constexpr int FieldVsize = 23;
+constexpr int FieldRss = 24;
+constexpr int FieldProcessor = 39;
+
+unsigned long long ParseULL(const char*& p, const char* end) {
+    unsigned long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<unsigned long long>(*p - '0');
+        ++p;
+    }
+    return v;
+}
+
+void SkipField(const char*& p, const char* end) {
+    while (p < end && *p != ' ') ++p;
+}
+} // namespace
+
+uint64_t HashBytes(const char* data, size_t len) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool ParseProcStat(const char* data, size_t len, ProcStatRecord& out, bool withProcessor) {
+    const char* end = data + len;
+    const char* p = data;
+
+    int pid = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        pid = pid * 10 + (*p - '0');
+        ++p;
+    }
+    if (p == data || p + 1 >= end || p[0] != ' ' || p[1] != '(') return false;
+
+    // comm may itself contain ')' or spaces, so it ends at the last ')'.
+    const char* commBegin = p + 2;
+    const char* commEnd = end;
+    while (commEnd > commBegin && commEnd[-1] != ')') --commEnd;
+    if (commEnd == commBegin) return false;
+    --commEnd;
+
+    size_t commLen = static_cast<size_t>(commEnd - commBegin);
+    if (commLen >= sizeof(out.comm)) commLen = sizeof(out.comm) - 1;
+    std::memcpy(out.comm, commBegin, commLen);
+    out.comm[commLen] = '\0';
+    out.commLen = static_cast<int>(commLen);
+    out.pid = pid;
+
+    // Remaining fields are space separated and start at field 3 (state)
+    p = commEnd + 1;
+    for (int field = 3; p < end && *p == ' '; ++field) {
+        ++p;
+        switch (field) {
+        case FieldState:
+            if (p < end) out.state = *p;
+            SkipField(p, end);
+            break;
+        case FieldPpid: out.ppid = static_cast<int>(ParseULL(p, end)); break;
+        case FieldUtime: out.utime = ParseULL(p, end); break;
+        case FieldStime: out.stime = ParseULL(p, end); break;
+        case FieldNumThreads: out.numThreads = static_cast<int>(ParseULL(p, end)); break;
+        case FieldStartTime: out.startTime = ParseULL(p, end); break;
+        case FieldVsize: out.vsizeBytes = ParseULL(p, end); break;
+        case FieldRss: out.rssPages = ParseULL(p, end); break;
+        case FieldProcessor: out.processor = static_cast<int>(ParseULL(p, end)); break;
+        default: SkipField(p, end); break;
+        }
+        if (field == (withProcessor ? FieldProcessor : FieldRss)) break;
+    }
+
+    out.statHash = HashBytes(data, len);
+    return true;
+}
+
+bool ParseProcIo(const char* data, size_t len, ProcStatRecord& out) {
+    // "name: value" lines; rchar/wchar count cached I/O too, so they're skipped
+    const char* p = data;
+    const char* end = data + len;
+    int found = 0;
+    while (p < end) {
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', static_cast<size_t>(end - p)));
+        if (!colon) break;
+        std::string_view name(p, static_cast<size_t>(colon - p));
+        p = colon + 1;
+        while (p < end && *p == ' ') ++p;
+        unsigned long long v = ParseULL(p, end);
+        if (name == "read_bytes") {
+            out.ioReadBytes = v;
+            ++found;
+        } else if (name == "write_bytes") {
+            out.ioWriteBytes = v;
+            ++found;
+        } else if (name == "syscr") {
+            out.ioSyscr = v;
+            ++found;
+        } else if (name == "syscw") {
+            out.ioSyscw = v;
+            ++found;
+        }
+        while (p < end && *p != '\n') ++p;
+        ++p;
+    }
+    out.hasIo = found == 4;
+    if (out.hasIo) out.statHash ^= HashBytes(data, len) * 31;
+    return out.hasIo;
+}
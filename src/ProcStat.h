@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One parsed /proc/<pid>/stat line. Fixed size so a scan never allocates per process.
+struct ProcStatRecord {
+    int pid = 0;
+    int commLen = 0;
+    char comm[64]{}; // kernel threads may report names longer than TASK_COMM_LEN
+    char state = '?';
+    int ppid = 0;                     // 0 when the parent is outside our pid namespace
+    int numThreads = 0;
+    unsigned long long utime = 0;     // clock ticks
+    unsigned long long stime = 0;     // clock ticks
+    unsigned long long startTime = 0; // clock ticks after boot; (pid, startTime) identifies a process
+    unsigned long long vsizeBytes = 0;
+    unsigned long long rssPages = 0;
+    int processor = -1;               // CPU it last ran on; only parsed on request
+    uint64_t statHash = 0;            // hash of the raw line, used to skip unchanged entries
+
+    // From /proc/<pid>/io when the scanner reads it; cumulative since start
+    bool hasIo = false;
+    unsigned long long ioReadBytes = 0;  // read_bytes: reached the storage layer
+    unsigned long long ioWriteBytes = 0; // write_bytes
+    unsigned long long ioSyscr = 0;      // read syscalls
+    unsigned long long ioSyscw = 0;      // write syscalls
+};
+
+// Parses the contents of /proc/<pid>/stat. Returns false on malformed input.
+// Parsing stops after rss unless withProcessor asks for field 39 as well.
+bool ParseProcStat(const char* data, size_t len, ProcStatRecord& out, bool withProcessor = false);
+
+// Parses the contents of /proc/<pid>/io into out's io fields and folds them
+// into statHash, so a process whose only change is I/O still shows as changed.
+bool ParseProcIo(const char* data, size_t len, ProcStatRecord& out);
+
+// FNV-1a over a byte range
+uint64_t HashBytes(const char* data, size_t len);
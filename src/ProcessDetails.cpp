@@ -0,0 +1,108 @@
+#include "ProcessDetails.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Command lines and environments can be huge; the UI shows a line or a list
+constexpr size_t MaxCmdlineBytes = 4096;
+constexpr size_t MaxEnvironBytes = 64 * 1024;
+
+#if defined(__linux__)
+bool ReadProcFile(int pid, const char* name, std::string& out, size_t maxBytes) {
+    out.clear();
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    out.resize(maxBytes);
+    size_t len = 0;
+    while (len < maxBytes) {
+        ssize_t n = read(fd, out.data() + len, maxBytes - len);
+        if (n <= 0) break;
+        len += static_cast<size_t>(n);
+    }
+    close(fd);
+    out.resize(len);
+    return true;
+}
+
+bool StillSameProcess(const ProcessKey& key) {
+    std::string stat;
+    ProcStatRecord rec;
+    return ReadProcFile(key.pid, "stat", stat, 1024) && ParseProcStat(stat.data(), stat.size(), rec) &&
+           rec.startTime == key.startTime;
+}
+#endif
+} // namespace
+
+bool LoadProcessDetails(const ProcessKey& key, bool withEnviron, ProcessDetails& out) {
+    out = ProcessDetails{};
+#if defined(__linux__)
+    if (!ReadProcFile(key.pid, "cmdline", out.cmdline, MaxCmdlineBytes)) return false;
+    while (!out.cmdline.empty() && out.cmdline.back() == '\0') out.cmdline.pop_back();
+    std::replace(out.cmdline.begin(), out.cmdline.end(), '\0', ' ');
+
+    char path[64];
+    char exe[4096];
+    std::snprintf(path, sizeof(path), "/proc/%d/exe", key.pid);
+    ssize_t n = readlink(path, exe, sizeof(exe));
+    if (n > 0) out.exe.assign(exe, static_cast<size_t>(n));
+
+    if (withEnviron) {
+        // Usually only readable for our own user's processes
+        std::string env;
+        if (ReadProcFile(key.pid, "environ", env, MaxEnvironBytes)) {
+            for (size_t pos = 0; pos < env.size();) {
+                size_t end = env.find('\0', pos);
+                if (end == std::string::npos) end = env.size();
+                if (end > pos) out.environ.emplace_back(env, pos, end - pos);
+                pos = end + 1;
+            }
+        }
+        out.hasEnviron = true;
+    }
+
+    // Read after the files: if the pid was reused meanwhile, they may belong to the new process
+    return StillSameProcess(key);
+#else
+    (void)key;
+    (void)withEnviron;
+    return false;
+#endif
+}
+
+std::shared_ptr<const ProcessDetails> ProcessDetailsCache::Find(const ProcessKey& key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) return nullptr;
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    return it->second.details;
+}
+
+void ProcessDetailsCache::Insert(const ProcessKey& key, std::shared_ptr<const ProcessDetails> details) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->second.details = std::move(details);
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        return;
+    }
+    if (m_capacity == 0) return;
+    if (m_entries.size() >= m_capacity) {
+        m_entries.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+    m_lru.push_front(key);
+    m_entries.emplace(key, Entry{std::move(details), m_lru.begin()});
+}
+
+void ProcessDetailsCache::Erase(const ProcessKey& key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) return;
+    m_lru.erase(it->second.lru);
+    m_entries.erase(it);
+}
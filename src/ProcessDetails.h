@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ProcessTable.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// What comm doesn't say about a process. Read when the process is indexed
+// for search (or on demand), not by the stat scan.
+struct ProcessDetails {
+    std::string cmdline; // arguments joined by spaces; empty for kernel threads
+    std::string exe;     // resolved executable, empty if unreadable
+    bool hasEnviron = false;
+    std::vector<std::string> environ; // NAME=value, only when requested
+    // Nothing could be read: the process exited or its pid was reused first,
+    // or the platform has no such data. Cached so it isn't retried.
+    bool missing = false;
+};
+
+// Reads the details of key's process (Linux: /proc/<pid>/cmdline, exe and
+// optionally environ). Returns false if the process is gone or the pid now
+// belongs to a different process.
+bool LoadProcessDetails(const ProcessKey& key, bool withEnviron, ProcessDetails& out);
+
+// Size-bounded LRU of ProcessDetails keyed by process identity. An entry is
+// loaded once per process lifetime (a reused pid has a different key), and
+// again after an exec. Entries are immutable once published, so callers may
+// keep the pointer. Not thread-safe.
+class ProcessDetailsCache {
+public:
+    explicit ProcessDetailsCache(size_t capacity = 2048) : m_capacity(capacity) {}
+
+    // Cached entry for key, or null on a miss; a hit becomes most recent
+    std::shared_ptr<const ProcessDetails> Find(const ProcessKey& key);
+    void Insert(const ProcessKey& key, std::shared_ptr<const ProcessDetails> details);
+    void Erase(const ProcessKey& key);
+
+    size_t Size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        std::shared_ptr<const ProcessDetails> details;
+        std::list<ProcessKey>::iterator lru;
+    };
+
+    size_t m_capacity;
+    std::unordered_map<ProcessKey, Entry, ProcessKeyHash> m_entries;
+    std::list<ProcessKey> m_lru; // most recently used first
+};
@@ -0,0 +1,108 @@
+#include "ProcessFilter.h"
+
+#include <algorithm>
+#include <cctype>
+
+bool ProcessFilter::Update(const ProcessTable& table, const SearchIndex& index, std::string_view query,
+                           SearchMode mode) {
+    if (mode == m_mode && query == m_query) {
+        if (query.empty()) {
+            // Everything matches, so only arrivals and exits matter
+            if (m_generation == table.Generation()) return false;
+            m_generation = table.Generation();
+            m_indexVersion = index.Version();
+            m_scratch.clear();
+            table.ForEachSlot([&](uint32_t slot) { m_scratch.push_back(slot); });
+            if (m_scratch == m_matches) return false;
+            m_matches.swap(m_scratch);
+            ++m_version;
+            return true;
+        }
+        if (m_indexVersion == index.Version()) return false;
+        m_changed.clear();
+        if (index.ChangedSince(m_indexVersion, m_changed)) {
+            m_indexVersion = index.Version();
+            if (!Merge(index)) return false;
+            ++m_version;
+            return true;
+        }
+        Run(table, index, false);
+        return true;
+    }
+
+    // A longer substring can only drop rows, never add them
+    const bool narrow = m_indexVersion == index.Version() && mode == SearchMode::Substring && m_mode == mode &&
+                        query.size() > m_query.size() && query.compare(0, m_query.size(), m_query) == 0;
+    m_query.assign(query);
+    m_queryLower.assign(query);
+    for (char& c : m_queryLower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    m_mode = mode;
+    Run(table, index, narrow);
+    return true;
+}
+
+void ProcessFilter::Run(const ProcessTable& table, const SearchIndex& index, bool narrow) {
+    m_error.clear();
+    m_ranked.clear();
+    m_regexValid = false;
+    if (m_query.empty()) {
+        m_matches.clear();
+        table.ForEachSlot([&](uint32_t slot) { m_matches.push_back(slot); });
+    } else if (narrow) {
+        m_matches.erase(std::remove_if(m_matches.begin(), m_matches.end(),
+                                       [&](uint32_t slot) { return !index.Contains(slot, m_queryLower); }),
+                        m_matches.end());
+    } else if (m_mode == SearchMode::Fuzzy) {
+        index.FindFuzzy(m_queryLower, m_ranked);
+        m_matches.clear();
+        for (const auto& r : m_ranked) m_matches.push_back(r.slot);
+    } else if (m_mode == SearchMode::Regex) {
+        m_matches.clear();
+        m_regexValid = SearchIndex::CompileRegex(m_query, m_regex, m_error);
+        if (m_regexValid) index.FindRegex(m_regex, m_matches);
+    } else {
+        index.FindSubstring(m_queryLower, m_matches);
+    }
+    m_generation = table.Generation();
+    m_indexVersion = index.Version();
+    ++m_version;
+}
+
+bool ProcessFilter::Merge(const SearchIndex& index) {
+    std::sort(m_changed.begin(), m_changed.end());
+    m_changed.erase(std::unique(m_changed.begin(), m_changed.end()), m_changed.end());
+    auto changed = [&](uint32_t slot) { return std::binary_search(m_changed.begin(), m_changed.end(), slot); };
+
+    if (m_mode == SearchMode::Fuzzy) {
+        const size_t before = m_ranked.size();
+        m_ranked.erase(std::remove_if(m_ranked.begin(), m_ranked.end(),
+                                      [&](const SearchIndex::FuzzyMatch& r) { return changed(r.slot); }),
+                       m_ranked.end());
+        const size_t kept = m_ranked.size();
+        for (uint32_t slot : m_changed) {
+            SearchIndex::FuzzyMatch match;
+            if (index.ScoreFuzzy(slot, m_queryLower, match)) m_ranked.push_back(match);
+        }
+        if (kept == before && m_ranked.size() == kept) return false;
+        std::sort(m_ranked.begin(), m_ranked.end());
+        m_matches.clear();
+        for (const auto& r : m_ranked) m_matches.push_back(r.slot);
+        return true;
+    }
+
+    const size_t before = m_matches.size();
+    m_matches.erase(std::remove_if(m_matches.begin(), m_matches.end(), changed), m_matches.end());
+    const size_t kept = m_matches.size();
+    // m_changed is sorted, so the new matches are too
+    for (uint32_t slot : m_changed) {
+        if (Test(index, slot)) m_matches.push_back(slot);
+    }
+    if (kept == before && m_matches.size() == kept) return false;
+    std::inplace_merge(m_matches.begin(), m_matches.begin() + static_cast<std::ptrdiff_t>(kept), m_matches.end());
+    return true;
+}
+
+bool ProcessFilter::Test(const SearchIndex& index, uint32_t slot) const {
+    if (m_mode == SearchMode::Regex) return m_regexValid && index.MatchesRegex(slot, m_regex);
+    return index.Contains(slot, m_queryLower);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ProcessTable.h"
+#include "SearchIndex.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Incremental process search on top of SearchIndex. A query only depends on
+// the indexed text, so stat and rate updates never re-evaluate it. When the
+// index changes under an unchanged query, only the slots it logged as added
+// or removed are re-tested and merged into the previous matches; the query
+// runs in full only when it or the mode changes (or the log ran out). In
+// substring mode a query that extends the previous one only re-tests the
+// previous matches, so typing gets cheaper with every keystroke.
+class ProcessFilter {
+public:
+    // Returns false (and leaves Matches() alone) when the matches didn't change
+    bool Update(const ProcessTable& table, const SearchIndex& index, std::string_view query, SearchMode mode);
+
+    // Matching slots: slot order, or best first in fuzzy mode
+    const std::vector<uint32_t>& Matches() const { return m_matches; }
+
+    // Why the last regex query matched nothing, or empty
+    const std::string& Error() const { return m_error; }
+
+    // Bumped whenever Matches() changes
+    uint64_t Version() const { return m_version; }
+
+private:
+    void Run(const ProcessTable& table, const SearchIndex& index, bool narrow);
+    // Re-tests the slots in m_changed; true if any match came or went
+    bool Merge(const SearchIndex& index);
+    bool Test(const SearchIndex& index, uint32_t slot) const;
+
+    std::string m_query;      // as typed; regex patterns keep their case
+    std::string m_queryLower;
+    SearchMode m_mode = SearchMode::Substring;
+    uint64_t m_generation = UINT64_MAX;   // table's, for the empty query
+    uint64_t m_indexVersion = UINT64_MAX; // index's, for the rest
+    uint64_t m_version = 0;
+    std::vector<uint32_t> m_matches;
+    std::vector<SearchIndex::FuzzyMatch> m_ranked; // fuzzy mode: m_matches with their scores
+    SearchIndex::RegexQuery m_regex;               // regex mode, when it compiled
+    bool m_regexValid = false;
+    std::vector<uint32_t> m_changed; // scratch
+    std::vector<uint32_t> m_scratch;
+    std::string m_error;
+};
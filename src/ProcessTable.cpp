@@ -0,0 +1,453 @@
+#include "ProcessTable.h"
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace {
+void FormatPid(int pid, std::array<char, 12>& out) {
+    auto [end, ec] = std::to_chars(out.data(), out.data() + out.size() - 1, pid);
+    *(ec == std::errc() ? end : out.data()) = '\0';
+}
+
+// value(slot) is the ranking key; it's only called for live slots
+template <typename ValueFn>
+void SelectTop(const std::vector<uint8_t>& live, ValueFn value, size_t k, std::vector<uint32_t>& out) {
+    out.clear();
+    if (k == 0) return;
+    using T = decltype(value(uint32_t{}));
+    struct Entry {
+        T value;
+        uint32_t slot;
+    };
+    auto stronger = [](const Entry& a, const Entry& b) {
+        return a.value != b.value ? a.value > b.value : a.slot < b.slot;
+    };
+    // Heap ordered by stronger: the front is the weakest of the current top k
+    std::vector<Entry> heap;
+    heap.reserve(k);
+    const uint32_t n = static_cast<uint32_t>(live.size());
+    for (uint32_t slot = 0; slot < n; ++slot) {
+        if (!live[slot]) continue;
+        const T v = value(slot);
+        if (heap.size() < k) {
+            heap.push_back(Entry{v, slot});
+            std::push_heap(heap.begin(), heap.end(), stronger);
+        } else if (v > heap.front().value) {
+            // Scanning in slot order, an equal value never displaces an entry
+            std::pop_heap(heap.begin(), heap.end(), stronger);
+            heap.back() = Entry{v, slot};
+            std::push_heap(heap.begin(), heap.end(), stronger);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), stronger);
+    for (const Entry& e : heap) out.push_back(e.slot);
+}
+
+// Per-second rate of a cumulative column since the previous call; free slots
+// hold zeros in both columns
+void CounterRates(const std::vector<uint64_t>& cur, std::vector<uint64_t>& prev, std::vector<float>& out,
+                  float perSecond) {
+    const size_t n = cur.size();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<float>(cur[i] - prev[i]) * perSecond;
+        prev[i] = cur[i];
+    }
+}
+} // namespace
+
+void ProcessTable::BeginScan() {
+    ++m_epoch;
+}
+
+void ProcessTable::Observe(const ProcStatRecord& rec) {
+    ProcessKey key{rec.pid, rec.startTime};
+
+    auto it = m_slotByPid.find(rec.pid);
+    if (it != m_slotByPid.end()) {
+        uint32_t slot = it->second;
+        m_cols.seenEpoch[slot] = m_epoch;
+        if (m_cols.key[slot] == key) {
+            if (m_cols.statHash[slot] == rec.statHash) return;
+            ++m_dataVersion;
+            MarkChanged(slot);
+            const int oldPpid = m_cols.ppid[slot];
+            Assign(slot, rec);
+            if (m_cols.ppid[slot] != oldPpid) {
+                // Reparented, typically to init or a subreaper after its parent exited
+                Unlink(slot);
+                Link(slot);
+            }
+            m_pending.changed.push_back(key);
+            return;
+        }
+        // Same pid, different start time: the old process is gone
+        ++m_dataVersion;
+        MarkChanged(slot);
+        m_pending.removed.push_back(m_cols.key[slot]);
+        Unlink(slot);
+        OrphanChildren(slot);
+        m_cols.key[slot] = key;
+        ClearIo(slot);
+        Assign(slot, rec);
+        Link(slot);
+        ClearMemoryBreakdown(slot);
+        m_cols.prevCpuTicks[slot] = m_cols.cpuTicks[slot];
+        m_cols.cpuPercent[slot] = 0.0f;
+        m_pending.added.push_back(key);
+        return;
+    }
+
+    ++m_dataVersion;
+    uint32_t slot = AllocSlot();
+    m_cols.key[slot] = key;
+    FormatPid(rec.pid, m_cols.pidText[slot]);
+    m_cols.seenEpoch[slot] = m_epoch;
+    Assign(slot, rec);
+    // First sighting: no interval to attribute its lifetime ticks to
+    m_cols.prevCpuTicks[slot] = m_cols.cpuTicks[slot];
+    m_slotByPid.emplace(rec.pid, slot);
+    MarkChanged(slot);
+    Link(slot);
+    m_pending.added.push_back(key);
+}
+
+void ProcessTable::EndScan() {
+    for (uint32_t slot = 0; slot < m_cols.live.size(); ++slot) {
+        if (m_cols.live[slot] && m_cols.seenEpoch[slot] != m_epoch) {
+            ++m_dataVersion;
+            m_pending.removed.push_back(m_cols.key[slot]);
+            m_slotByPid.erase(m_cols.key[slot].pid);
+            FreeSlot(slot);
+        }
+    }
+}
+
+void ProcessTable::Remove(int pid) {
+    auto it = m_slotByPid.find(pid);
+    if (it == m_slotByPid.end()) return;
+    uint32_t slot = it->second;
+    ++m_dataVersion;
+    m_pending.removed.push_back(m_cols.key[slot]);
+    m_slotByPid.erase(it);
+    FreeSlot(slot);
+}
+
+void ProcessTable::ComputeRates(double elapsedTicksPerCpu, double elapsedSeconds) {
+    ++m_dataVersion;
+    m_allRowsChanged = true;
+    const size_t n = m_cols.cpuTicks.size();
+    const float scale = elapsedTicksPerCpu > 0.0 ? static_cast<float>(100.0 / elapsedTicksPerCpu) : 0.0f;
+    const uint64_t* cur = m_cols.cpuTicks.data();
+    uint64_t* prev = m_cols.prevCpuTicks.data();
+    float* out = m_cols.cpuPercent.data();
+
+    // Free slots hold zeros in both tick columns, so no live-mask branch is needed
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<float>(cur[i] - prev[i]) * scale;
+        prev[i] = cur[i];
+    }
+
+    const float perSecond = elapsedSeconds > 0.0 ? static_cast<float>(1.0 / elapsedSeconds) : 0.0f;
+    CounterRates(m_cols.ioReadBytes, m_cols.prevIoReadBytes, m_cols.ioReadRate, perSecond);
+    CounterRates(m_cols.ioWriteBytes, m_cols.prevIoWriteBytes, m_cols.ioWriteRate, perSecond);
+    CounterRates(m_cols.ioSyscr, m_cols.prevIoSyscr, m_cols.ioSyscrRate, perSecond);
+    CounterRates(m_cols.ioSyscw, m_cols.prevIoSyscw, m_cols.ioSyscwRate, perSecond);
+}
+
+void ProcessTable::SetMemoryBreakdown(const ProcessKey& key, uint64_t pss, uint64_t uss, uint64_t swap) {
+    int slot = FindSlot(key.pid);
+    if (slot < 0 || !(m_cols.key[slot] == key)) return;
+    m_cols.pssBytes[slot] = pss;
+    m_cols.ussBytes[slot] = uss;
+    m_cols.swapBytes[slot] = swap;
+    m_cols.memSampled[slot] = 1;
+    ++m_dataVersion;
+    MarkChanged(static_cast<uint32_t>(slot));
+}
+
+void ProcessTable::MarkChanged(uint32_t slot) {
+    if (m_allRowsChanged) return;
+    if (slot >= m_rowChanged.size()) m_rowChanged.resize(m_cols.key.size(), 0);
+    if (m_rowChanged[slot]) return;
+    m_rowChanged[slot] = 1;
+    m_changedRows.push_back(slot);
+}
+
+void ProcessTable::TakeChangedRows(std::vector<uint32_t>& out, bool& all) {
+    out.swap(m_changedRows);
+    m_changedRows.clear();
+    for (uint32_t slot : out) m_rowChanged[slot] = 0;
+    all = m_allRowsChanged;
+    m_allRowsChanged = false;
+}
+
+void ProcessTable::ClearMemoryBreakdown(uint32_t slot) {
+    m_cols.pssBytes[slot] = 0;
+    m_cols.ussBytes[slot] = 0;
+    m_cols.swapBytes[slot] = 0;
+    m_cols.memSampled[slot] = 0;
+}
+
+void ProcessTable::ClearIo(uint32_t slot) {
+    m_cols.hasIo[slot] = 0;
+    m_cols.ioReadBytes[slot] = 0;
+    m_cols.ioWriteBytes[slot] = 0;
+    m_cols.ioSyscr[slot] = 0;
+    m_cols.ioSyscw[slot] = 0;
+    m_cols.prevIoReadBytes[slot] = 0;
+    m_cols.prevIoWriteBytes[slot] = 0;
+    m_cols.prevIoSyscr[slot] = 0;
+    m_cols.prevIoSyscw[slot] = 0;
+    m_cols.ioReadRate[slot] = 0.0f;
+    m_cols.ioWriteRate[slot] = 0.0f;
+    m_cols.ioSyscrRate[slot] = 0.0f;
+    m_cols.ioSyscwRate[slot] = 0.0f;
+}
+
+void ProcessTable::TakeDelta(ProcessDelta& out) {
+    std::swap(out, m_pending);
+    m_pending.Clear();
+    if (!out.Empty()) ++m_generation;
+    out.generation = m_generation;
+}
+
+void ProcessTable::UpdateTree() {
+    // Only a link, depth or rollup that actually moved bumps DataVersion();
+    // the event path calls this on every poll
+    bool changed = false;
+    bool treeChanged = false;
+    m_linkRetry.swap(m_unlinked);
+    m_unlinked.clear();
+    for (const ProcessKey& key : m_linkRetry) {
+        int slot = FindSlot(key.pid);
+        if (slot >= 0 && m_cols.key[slot] == key && m_cols.parent[slot] < 0) {
+            Link(static_cast<uint32_t>(slot));
+            changed |= m_cols.parent[slot] >= 0;
+        }
+    }
+    m_linkRetry.clear();
+
+    // Rollups are summed into scratch columns first, so they can be compared
+    const size_t n = m_cols.key.size();
+    m_rollDescendants.resize(n);
+    m_rollCpu.resize(n);
+    m_rollRss.resize(n);
+    m_prevTreeOrder.swap(m_treeOrder);
+    m_treeOrder.clear();
+    ForEachSlot([&](uint32_t root) {
+        if (m_cols.parent[root] >= 0) return;
+        ForEachInSubtree(root, [&](uint32_t slot, uint32_t depth) {
+            if (m_cols.depth[slot] != depth) {
+                treeChanged = true;
+                MarkChanged(slot);
+            }
+            m_cols.depth[slot] = depth;
+            m_rollDescendants[slot] = 0;
+            m_rollCpu[slot] = m_cols.cpuPercent[slot];
+            m_rollRss[slot] = m_cols.rssBytes[slot];
+            m_treeOrder.push_back(slot);
+        });
+    });
+    treeChanged |= m_treeOrder != m_prevTreeOrder;
+    changed |= treeChanged;
+
+    // Reverse preorder folds every child into its parent before the parent
+    // is folded into its own
+    for (auto it = m_treeOrder.rbegin(); it != m_treeOrder.rend(); ++it) {
+        const int32_t p = m_cols.parent[*it];
+        if (p < 0) continue;
+        m_rollDescendants[p] += m_rollDescendants[*it] + 1;
+        m_rollCpu[p] += m_rollCpu[*it];
+        m_rollRss[p] += m_rollRss[*it];
+    }
+    for (uint32_t slot : m_treeOrder) {
+        if (m_cols.descendants[slot] != m_rollDescendants[slot] || m_cols.subtreeCpu[slot] != m_rollCpu[slot] ||
+            m_cols.subtreeRss[slot] != m_rollRss[slot]) {
+            changed = true;
+            MarkChanged(slot);
+        }
+        m_cols.descendants[slot] = m_rollDescendants[slot];
+        m_cols.subtreeCpu[slot] = m_rollCpu[slot];
+        m_cols.subtreeRss[slot] = m_rollRss[slot];
+    }
+    if (changed) ++m_dataVersion;
+    if (treeChanged) ++m_treeVersion;
+}
+
+void ProcessTable::Link(uint32_t slot) {
+    const int ppid = m_cols.ppid[slot];
+    if (ppid <= 0) return; // a root
+    const int p = FindSlot(ppid);
+    // A parent started after its child is an unrelated process that reused the pid
+    if (p < 0 || m_cols.key[p].startTime > m_cols.key[slot].startTime) {
+        m_unlinked.push_back(m_cols.key[slot]);
+        return;
+    }
+    // Inconsistent snapshots (pid reuse within one clock tick) must not close a loop
+    for (int32_t a = p; a >= 0; a = m_cols.parent[a]) {
+        if (a == static_cast<int32_t>(slot)) return;
+    }
+
+    const int32_t next = m_cols.firstChild[p];
+    m_cols.parent[slot] = p;
+    m_cols.prevSibling[slot] = -1;
+    m_cols.nextSibling[slot] = next;
+    if (next >= 0) m_cols.prevSibling[next] = static_cast<int32_t>(slot);
+    m_cols.firstChild[p] = static_cast<int32_t>(slot);
+}
+
+void ProcessTable::Unlink(uint32_t slot) {
+    const int32_t p = m_cols.parent[slot];
+    if (p < 0) return;
+    const int32_t prev = m_cols.prevSibling[slot];
+    const int32_t next = m_cols.nextSibling[slot];
+    if (prev >= 0) {
+        m_cols.nextSibling[prev] = next;
+    } else {
+        m_cols.firstChild[p] = next;
+    }
+    if (next >= 0) m_cols.prevSibling[next] = prev;
+    m_cols.parent[slot] = -1;
+    m_cols.prevSibling[slot] = -1;
+    m_cols.nextSibling[slot] = -1;
+}
+
+void ProcessTable::OrphanChildren(uint32_t slot) {
+    // They stay roots until the kernel's reparenting shows up in their stat line
+    for (int32_t c = m_cols.firstChild[slot]; c >= 0;) {
+        const int32_t next = m_cols.nextSibling[c];
+        m_cols.parent[c] = -1;
+        m_cols.prevSibling[c] = -1;
+        m_cols.nextSibling[c] = -1;
+        c = next;
+    }
+    m_cols.firstChild[slot] = -1;
+}
+
+void ProcessTable::TopSlots(TopMetric metric, size_t k, std::vector<uint32_t>& out) const {
+    switch (metric) {
+    case TopMetric::Cpu:
+        SelectTop(m_cols.live, [&](uint32_t s) { return m_cols.cpuPercent[s]; }, k, out);
+        break;
+    case TopMetric::Rss:
+        SelectTop(m_cols.live, [&](uint32_t s) { return m_cols.rssBytes[s]; }, k, out);
+        break;
+    case TopMetric::Io:
+        SelectTop(m_cols.live, [&](uint32_t s) { return m_cols.ioReadRate[s] + m_cols.ioWriteRate[s]; }, k, out);
+        break;
+    }
+}
+
+int ProcessTable::FindSlot(int pid) const {
+    auto it = m_slotByPid.find(pid);
+    return it == m_slotByPid.end() ? -1 : static_cast<int>(it->second);
+}
+
+void ProcessTable::Assign(uint32_t slot, const ProcStatRecord& rec) {
+    m_cols.statHash[slot] = rec.statHash;
+    // comm can change on exec/prctl; only intern when it did
+    std::string_view comm(rec.comm, static_cast<size_t>(rec.commLen));
+    StringPool::Id& nameId = m_cols.nameId[slot];
+    if (m_names.Get(nameId) != comm) {
+        nameId = m_names.Intern(comm);
+    }
+    m_cols.state[slot] = rec.state;
+    m_cols.ppid[slot] = rec.ppid;
+    m_cols.threads[slot] = static_cast<uint32_t>(rec.numThreads);
+    m_cols.cpuTicks[slot] = rec.utime + rec.stime;
+    m_cols.rssBytes[slot] = rec.rssPages * m_pageSize;
+    m_cols.vsizeBytes[slot] = rec.vsizeBytes;
+    // A failed io read keeps the last values, so the rate just reads 0
+    if (rec.hasIo) {
+        m_cols.ioReadBytes[slot] = rec.ioReadBytes;
+        m_cols.ioWriteBytes[slot] = rec.ioWriteBytes;
+        m_cols.ioSyscr[slot] = rec.ioSyscr;
+        m_cols.ioSyscw[slot] = rec.ioSyscw;
+        if (!m_cols.hasIo[slot]) {
+            // Nothing to take a delta against yet
+            m_cols.hasIo[slot] = 1;
+            m_cols.prevIoReadBytes[slot] = rec.ioReadBytes;
+            m_cols.prevIoWriteBytes[slot] = rec.ioWriteBytes;
+            m_cols.prevIoSyscr[slot] = rec.ioSyscr;
+            m_cols.prevIoSyscw[slot] = rec.ioSyscw;
+        }
+    }
+}
+
+uint32_t ProcessTable::AllocSlot() {
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_cols.key.size());
+        const size_t n = slot + 1;
+        m_cols.key.resize(n);
+        m_cols.nameId.resize(n);
+        m_cols.pidText.resize(n);
+        m_cols.statHash.resize(n);
+        m_cols.seenEpoch.resize(n);
+        m_cols.live.resize(n);
+        m_cols.state.resize(n);
+        m_cols.threads.resize(n);
+        m_cols.cpuTicks.resize(n);
+        m_cols.prevCpuTicks.resize(n);
+        m_cols.cpuPercent.resize(n);
+        m_cols.rssBytes.resize(n);
+        m_cols.vsizeBytes.resize(n);
+        m_cols.hasIo.resize(n);
+        m_cols.ioReadBytes.resize(n);
+        m_cols.ioWriteBytes.resize(n);
+        m_cols.ioSyscr.resize(n);
+        m_cols.ioSyscw.resize(n);
+        m_cols.prevIoReadBytes.resize(n);
+        m_cols.prevIoWriteBytes.resize(n);
+        m_cols.prevIoSyscr.resize(n);
+        m_cols.prevIoSyscw.resize(n);
+        m_cols.ioReadRate.resize(n);
+        m_cols.ioWriteRate.resize(n);
+        m_cols.ioSyscrRate.resize(n);
+        m_cols.ioSyscwRate.resize(n);
+        m_cols.pssBytes.resize(n);
+        m_cols.ussBytes.resize(n);
+        m_cols.swapBytes.resize(n);
+        m_cols.memSampled.resize(n);
+        m_cols.ppid.resize(n);
+        m_cols.parent.resize(n, -1);
+        m_cols.firstChild.resize(n, -1);
+        m_cols.nextSibling.resize(n, -1);
+        m_cols.prevSibling.resize(n, -1);
+        m_cols.depth.resize(n);
+        m_cols.descendants.resize(n);
+        m_cols.subtreeCpu.resize(n);
+        m_cols.subtreeRss.resize(n);
+    }
+    m_cols.live[slot] = 1;
+    return slot;
+}
+
+void ProcessTable::FreeSlot(uint32_t slot) {
+    Unlink(slot);
+    OrphanChildren(slot);
+    m_cols.live[slot] = 0;
+    m_cols.key[slot] = ProcessKey{};
+    m_cols.nameId[slot] = StringPool::EmptyId;
+    m_cols.pidText[slot][0] = '\0';
+    m_cols.statHash[slot] = 0;
+    m_cols.state[slot] = '?';
+    m_cols.threads[slot] = 0;
+    m_cols.cpuTicks[slot] = 0;
+    m_cols.prevCpuTicks[slot] = 0;
+    m_cols.cpuPercent[slot] = 0.0f;
+    m_cols.rssBytes[slot] = 0;
+    m_cols.vsizeBytes[slot] = 0;
+    ClearIo(slot);
+    ClearMemoryBreakdown(slot);
+    m_cols.ppid[slot] = 0;
+    m_cols.depth[slot] = 0;
+    m_cols.descendants[slot] = 0;
+    m_cols.subtreeCpu[slot] = 0.0f;
+    m_cols.subtreeRss[slot] = 0;
+    m_freeSlots.push_back(slot);
+}
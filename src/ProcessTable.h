@@ -0,0 +1,220 @@
+#pragma once
+
+#include "ProcStat.h"
+#include "StringPool.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// A process identity: pids get reused, (pid, startTime) does not.
+struct ProcessKey {
+    int pid = 0;
+    unsigned long long startTime = 0;
+
+    bool operator==(const ProcessKey& o) const { return pid == o.pid && startTime == o.startTime; }
+};
+
+struct ProcessKeyHash {
+    size_t operator()(const ProcessKey& k) const {
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<unsigned>(k.pid)) ^ (k.startTime << 22)) *
+                                   0x9E3779B97F4A7C15ull);
+    }
+};
+
+// What changed between two table generations
+struct ProcessDelta {
+    uint64_t generation = 0;
+    std::vector<ProcessKey> added;
+    std::vector<ProcessKey> removed;
+    std::vector<ProcessKey> changed; // same identity, different stat contents
+
+    bool Empty() const { return added.empty() && removed.empty() && changed.empty(); }
+    void Clear() {
+        added.clear();
+        removed.clear();
+        changed.clear();
+    }
+};
+
+// Orderings for ProcessTable::TopSlots()
+enum class TopMetric { Cpu, Rss, Io }; // Io: read + write bytes per second
+
+// Persistent, column-oriented process table. Every column is indexed by a
+// stable slot; exited processes leave a zeroed hole that is reused by the
+// next arrival. Rows are only rewritten when a process's identity or stat
+// line actually changed, and per-tick rates are one linear pass per column.
+class ProcessTable {
+public:
+    struct Columns {
+        std::vector<ProcessKey> key;
+        std::vector<StringPool::Id> nameId; // into Names()
+        std::vector<std::array<char, 12>> pidText; // decimal pid, NUL-terminated, for search
+        std::vector<uint64_t> statHash;
+        std::vector<uint32_t> seenEpoch;
+        std::vector<uint8_t> live;
+        std::vector<char> state;
+        std::vector<uint32_t> threads;
+        std::vector<uint64_t> cpuTicks;     // utime + stime at the latest observation
+        std::vector<uint64_t> prevCpuTicks; // cpuTicks at the previous ComputeRates()
+        std::vector<float> cpuPercent;      // 100 = one fully busy core
+        std::vector<uint64_t> rssBytes;
+        std::vector<uint64_t> vsizeBytes;
+
+        // Storage I/O from /proc/<pid>/io; hasIo is 0 where it can't be read
+        // (other users' processes without root). Cumulative counters, their
+        // values at the previous ComputeRates(), and per-second rates.
+        std::vector<uint8_t> hasIo;
+        std::vector<uint64_t> ioReadBytes;
+        std::vector<uint64_t> ioWriteBytes;
+        std::vector<uint64_t> ioSyscr;
+        std::vector<uint64_t> ioSyscw;
+        std::vector<uint64_t> prevIoReadBytes;
+        std::vector<uint64_t> prevIoWriteBytes;
+        std::vector<uint64_t> prevIoSyscr;
+        std::vector<uint64_t> prevIoSyscw;
+        std::vector<float> ioReadRate;  // bytes/s
+        std::vector<float> ioWriteRate; // bytes/s
+        std::vector<float> ioSyscrRate; // calls/s
+        std::vector<float> ioSyscwRate; // calls/s
+
+        // Set by SetMemoryBreakdown(), which lags the scan; memSampled is 0
+        // until the first sample
+        std::vector<uint64_t> pssBytes;
+        std::vector<uint64_t> ussBytes;
+        std::vector<uint64_t> swapBytes;
+        std::vector<uint8_t> memSampled;
+
+        // Process tree as slot links, -1 for none. A parent's children form a
+        // doubly linked list through nextSibling/prevSibling.
+        std::vector<int> ppid;
+        std::vector<int32_t> parent;
+        std::vector<int32_t> firstChild;
+        std::vector<int32_t> nextSibling;
+        std::vector<int32_t> prevSibling;
+
+        // Filled by UpdateTree()
+        std::vector<uint32_t> depth;
+        std::vector<uint32_t> descendants;
+        std::vector<float> subtreeCpu; // own CPU% plus every descendant's
+        std::vector<uint64_t> subtreeRss;
+    };
+
+    // Full-scan protocol: every process not observed between BeginScan()
+    // and EndScan() is treated as exited.
+    void BeginScan();
+    void Observe(const ProcStatRecord& rec);
+    void EndScan();
+
+    // Drop a single process outside of a full scan
+    void Remove(int pid);
+
+    // Turns tick deltas since the previous call into CPU%, and I/O counter
+    // deltas into per-second rates. elapsedTicksPerCpu is the wall interval in
+    // clock ticks (system jiffy delta / CPU count), elapsedSeconds the same
+    // interval in seconds.
+    void ComputeRates(double elapsedTicksPerCpu, double elapsedSeconds);
+
+    // Links processes whose parent was observed after them, then recomputes
+    // TreeOrder() and the subtree rollups. Links themselves are maintained as
+    // processes come and go; this is one O(n) walk with no sorting. Bumps
+    // DataVersion() only if a link, depth or rollup changed.
+    void UpdateTree();
+
+    // Live slots in preorder (every parent before its children) as of the
+    // last UpdateTree()
+    const std::vector<uint32_t>& TreeOrder() const { return m_treeOrder; }
+
+    // Visits root and all its descendants in preorder: fn(slot, depth below root)
+    template <typename Fn>
+    void ForEachInSubtree(uint32_t root, Fn&& fn) const {
+        int32_t node = static_cast<int32_t>(root);
+        uint32_t depth = 0;
+        while (true) {
+            fn(static_cast<uint32_t>(node), depth);
+            if (m_cols.firstChild[node] >= 0) {
+                node = m_cols.firstChild[node];
+                ++depth;
+                continue;
+            }
+            while (node != static_cast<int32_t>(root) && m_cols.nextSibling[node] < 0) {
+                node = m_cols.parent[node];
+                --depth;
+            }
+            if (node == static_cast<int32_t>(root)) return;
+            node = m_cols.nextSibling[node];
+        }
+    }
+
+    // PSS, USS and swap from a background sample (see SmapsSampler). Ignored
+    // if key's process has exited since.
+    void SetMemoryBreakdown(const ProcessKey& key, uint64_t pss, uint64_t uss, uint64_t swap);
+
+    // Swaps the changes accumulated since the previous call into out and starts
+    // a new generation. out's old buffers are recycled, so this doesn't allocate.
+    void TakeDelta(ProcessDelta& out);
+
+    void SetPageSize(uint64_t bytes) { m_pageSize = bytes; }
+
+    size_t Size() const { return m_slotByPid.size(); }
+    size_t SlotCount() const { return m_cols.key.size(); }
+    uint64_t Generation() const { return m_generation; }
+
+    // Bumped by anything that changes visible column values, including rates
+    uint64_t DataVersion() const { return m_dataVersion; }
+    // Bumped when TreeOrder() or a depth changed
+    uint64_t TreeVersion() const { return m_treeVersion; }
+    // Swaps the slots whose visible values changed since the previous call
+    // into out. all is set instead when every row changed (a rate update).
+    void TakeChangedRows(std::vector<uint32_t>& out, bool& all);
+    const Columns& Cols() const { return m_cols; }
+    const StringPool& Names() const { return m_names; }
+
+    // The k live slots with the largest value of metric, largest first (ties
+    // go to the lower slot). One pass over a single column through a bounded
+    // min-heap, O(n log k), instead of sorting the table.
+    void TopSlots(TopMetric metric, size_t k, std::vector<uint32_t>& out) const;
+
+    // Slot of a live pid, or -1
+    int FindSlot(int pid) const;
+
+    template <typename Fn>
+    void ForEachSlot(Fn&& fn) const {
+        for (uint32_t slot = 0; slot < m_cols.live.size(); ++slot) {
+            if (m_cols.live[slot]) fn(slot);
+        }
+    }
+
+private:
+    uint32_t AllocSlot();
+    void FreeSlot(uint32_t slot);
+    void Assign(uint32_t slot, const ProcStatRecord& rec);
+    void Link(uint32_t slot);
+    void Unlink(uint32_t slot);
+    void OrphanChildren(uint32_t slot);
+    void ClearMemoryBreakdown(uint32_t slot);
+    void ClearIo(uint32_t slot);
+    void MarkChanged(uint32_t slot);
+
+    Columns m_cols;
+    StringPool m_names;
+    std::vector<uint32_t> m_freeSlots;
+    std::unordered_map<int, uint32_t> m_slotByPid;
+    uint32_t m_epoch = 0;
+    uint64_t m_generation = 0;
+    uint64_t m_dataVersion = 0;
+    uint64_t m_treeVersion = 0;
+    std::vector<uint32_t> m_changedRows;
+    std::vector<uint8_t> m_rowChanged; // by slot: already in m_changedRows
+    bool m_allRowsChanged = true;
+    uint64_t m_pageSize = 4096;
+    ProcessDelta m_pending;
+    std::vector<ProcessKey> m_unlinked; // parent not observed yet
+    std::vector<ProcessKey> m_linkRetry;
+    std::vector<uint32_t> m_treeOrder;
+    std::vector<uint32_t> m_prevTreeOrder;
+    std::vector<uint32_t> m_rollDescendants; // UpdateTree() scratch, by slot
+    std::vector<float> m_rollCpu;
+    std::vector<uint64_t> m_rollRss;
+};
@@ -0,0 +1,417 @@
+#include "SearchIndex.h"
+
+#include "SubstringSearch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <regex>
+
+namespace {
+// Stale postings (and removed texts) are swept once there are more of them than live ones
+constexpr size_t MinCompactPostings = 64 * 1024;
+constexpr size_t MinCompactText = 1024 * 1024;
+
+// Versions ChangedSince() can look back over; a full scan's worth of churn
+constexpr size_t MaxChangeLog = 16 * 1024;
+
+// Above this share of live documents in the shortest posting list, one pass
+// over all text is cheaper than verifying the candidates one by one
+constexpr size_t ScanFraction = 4;
+
+inline char LowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+inline uint32_t Trigram(const char* p) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 16 |
+           static_cast<uint32_t>(static_cast<unsigned char>(p[1])) << 8 |
+           static_cast<uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+// Distinct trigrams of s, skipping the newlines between fields
+void Trigrams(std::string_view s, std::vector<uint32_t>& out) {
+    out.clear();
+    for (size_t i = 0; i + 3 <= s.size(); ++i) {
+        if (s[i] == '\n' || s[i + 1] == '\n' || s[i + 2] == '\n') continue;
+        out.push_back(Trigram(s.data() + i));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+// libstdc++'s what() is just "regex_error"
+const char* RegexErrorText(std::regex_constants::error_type code) {
+    switch (code) {
+    case std::regex_constants::error_paren: return "unbalanced parentheses";
+    case std::regex_constants::error_brack: return "unbalanced brackets";
+    case std::regex_constants::error_brace: return "unbalanced braces";
+    case std::regex_constants::error_badbrace: return "invalid repeat count";
+    case std::regex_constants::error_range: return "invalid character range";
+    case std::regex_constants::error_escape: return "invalid escape";
+    case std::regex_constants::error_backref: return "invalid back reference";
+    case std::regex_constants::error_badrepeat: return "nothing to repeat";
+    case std::regex_constants::error_ctype: return "invalid character class";
+    case std::regex_constants::error_collate: return "invalid collating element";
+    case std::regex_constants::error_complexity:
+    case std::regex_constants::error_space:
+    case std::regex_constants::error_stack: return "pattern too complex";
+    default: return "invalid pattern";
+    }
+}
+
+// Literal runs (lowercased, 3+ chars) that every match of an ECMAScript
+// pattern must contain. Conservative: any top-level alternation disables the
+// prefilter, and groups, classes and optional characters just end a run.
+void RequiredLiterals(std::string_view p, std::vector<std::string>& out) {
+    std::string run;
+    auto flush = [&] {
+        if (run.size() >= 3) out.push_back(run);
+        run.clear();
+    };
+    auto skipClass = [&](size_t& i) {
+        // i is at '['; a ']' right after the opening bracket (or '^') is literal
+        ++i;
+        if (i < p.size() && p[i] == '^') ++i;
+        if (i < p.size() && p[i] == ']') ++i;
+        for (; i < p.size() && p[i] != ']'; ++i) {
+            if (p[i] == '\\') ++i;
+        }
+    };
+
+    for (size_t i = 0; i < p.size(); ++i) {
+        char c = p[i];
+        switch (c) {
+        case '|':
+            out.clear();
+            return;
+        case '(': {
+            flush();
+            int depth = 1;
+            for (++i; i < p.size() && depth > 0; ++i) {
+                if (p[i] == '\\') ++i;
+                else if (p[i] == '[') skipClass(i);
+                else if (p[i] == '(') ++depth;
+                else if (p[i] == ')') --depth;
+            }
+            --i;
+            continue;
+        }
+        case '[':
+            flush();
+            skipClass(i);
+            continue;
+        case '*':
+        case '?':
+        case '{':
+            // The preceding character may be absent
+            if (!run.empty()) run.pop_back();
+            flush();
+            if (c == '{') {
+                while (i < p.size() && p[i] != '}') ++i;
+            }
+            continue;
+        case '+':
+        case '.':
+        case '^':
+        case '$':
+        case ')':
+            flush();
+            continue;
+        case '\\':
+            if (i + 1 >= p.size()) {
+                flush();
+                continue;
+            }
+            c = p[++i];
+            if (std::isalnum(static_cast<unsigned char>(c))) {
+                // \d, \w, \b, \n, backreferences...; skip their operands too
+                flush();
+                if (c == 'x') i += 2;
+                else if (c == 'u') i += 4;
+                else if (c == 'c') i += 1;
+                else if (std::isdigit(static_cast<unsigned char>(c))) {
+                    while (i + 1 < p.size() && std::isdigit(static_cast<unsigned char>(p[i + 1]))) ++i;
+                }
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        run += LowerAscii(c);
+    }
+    flush();
+}
+} // namespace
+
+void SearchIndex::Add(uint32_t slot, const ProcessKey& key, StringPool::Id nameId, std::string_view pidText,
+                      std::string_view name, std::string_view cmdline) {
+    auto it = m_slotByPid.find(key.pid);
+    if (it != m_slotByPid.end()) RemoveSlot(it->second);
+    if (slot >= m_docs.size()) m_docs.resize(slot + 1);
+    if (m_docs[slot].live) RemoveSlot(slot);
+
+    Doc& doc = m_docs[slot];
+    doc.key = key;
+    doc.nameId = nameId;
+    doc.live = true;
+    ++doc.gen;
+
+    // Appended in place of the padding, which goes back after the separator
+    const size_t offset = TextEnd();
+    m_text.resize(offset);
+    m_text.append(pidText).append(1, '\n').append(name).append(1, '\n').append(cmdline);
+    for (size_t i = offset; i < m_text.size(); ++i) m_text[i] = LowerAscii(m_text[i]);
+    doc.offset = static_cast<uint32_t>(offset);
+    doc.length = static_cast<uint32_t>(m_text.size() - offset);
+    m_text.append(1, '\0').append(SearchPadding, '\0');
+    m_extents.push_back(Extent{doc.offset, doc.length, slot, doc.gen});
+
+    Trigrams(Text(doc), m_trigramScratch);
+    for (uint32_t t : m_trigramScratch) {
+        m_postings[t].push_back(Posting{slot, doc.gen});
+    }
+    doc.postings = static_cast<uint32_t>(m_trigramScratch.size());
+    m_livePostings += doc.postings;
+    m_textBytes += doc.length;
+    m_slotByPid[key.pid] = slot;
+    Touch(slot);
+}
+
+void SearchIndex::Touch(uint32_t slot) {
+    ++m_version;
+    if (m_changeLog.size() >= MaxChangeLog) {
+        // Drop the older half; a caller that far behind re-runs its query
+        const size_t drop = m_changeLog.size() / 2;
+        m_changeLog.erase(m_changeLog.begin(), m_changeLog.begin() + static_cast<std::ptrdiff_t>(drop));
+        m_changeLogBase += drop;
+    }
+    m_changeLog.push_back(slot);
+}
+
+bool SearchIndex::ChangedSince(uint64_t version, std::vector<uint32_t>& out) const {
+    if (version < m_changeLogBase || version > m_version) return false;
+    out.insert(out.end(), m_changeLog.begin() + static_cast<std::ptrdiff_t>(version - m_changeLogBase),
+               m_changeLog.end());
+    return true;
+}
+
+void SearchIndex::Remove(const ProcessKey& key) {
+    auto it = m_slotByPid.find(key.pid);
+    if (it == m_slotByPid.end() || !(m_docs[it->second].key == key)) return;
+    RemoveSlot(it->second);
+}
+
+void SearchIndex::RemoveSlot(uint32_t slot) {
+    Doc& doc = m_docs[slot];
+    if (!doc.live) return;
+    m_slotByPid.erase(doc.key.pid);
+    doc.live = false;
+    ++doc.gen; // orphans this document's postings
+    m_livePostings -= doc.postings;
+    m_deadPostings += doc.postings;
+    doc.postings = 0;
+    m_textBytes -= doc.length;
+    m_deadTextBytes += doc.length + 1;
+    doc.length = 0;
+    Touch(slot);
+
+    if (m_deadPostings > m_livePostings && m_deadPostings > MinCompactPostings) Compact();
+    // Command lines can be long; don't hold on to exited ones
+    if (m_deadTextBytes > m_textBytes && m_deadTextBytes > MinCompactText) CompactText();
+}
+
+void SearchIndex::CompactText() {
+    std::string text;
+    text.reserve(m_textBytes + m_slotByPid.size() + SearchPadding);
+    size_t kept = 0;
+    for (const Extent& e : m_extents) {
+        Doc& doc = m_docs[e.slot];
+        if (doc.gen != e.gen) continue;
+        doc.offset = static_cast<uint32_t>(text.size());
+        text.append(m_text, e.offset, e.length).append(1, '\0');
+        m_extents[kept++] = Extent{doc.offset, doc.length, e.slot, e.gen};
+    }
+    m_extents.resize(kept);
+    if (!text.empty()) text.append(SearchPadding, '\0');
+    m_text.swap(text);
+    m_deadTextBytes = 0;
+}
+
+void SearchIndex::Compact() {
+    for (auto it = m_postings.begin(); it != m_postings.end();) {
+        PostingList& list = it->second;
+        list.erase(std::remove_if(list.begin(), list.end(), [&](const Posting& p) { return !IsCurrent(p); }),
+                   list.end());
+        if (list.empty()) {
+            it = m_postings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_deadPostings = 0;
+}
+
+bool SearchIndex::IsIndexed(const ProcessKey& key, StringPool::Id nameId) const {
+    auto it = m_slotByPid.find(key.pid);
+    if (it == m_slotByPid.end()) return false;
+    const Doc& doc = m_docs[it->second];
+    return doc.key == key && doc.nameId == nameId;
+}
+
+bool SearchIndex::Contains(uint32_t slot, std::string_view needleLower) const {
+    if (slot >= m_docs.size() || !m_docs[slot].live) return false;
+    // The next document (or the trailing padding) follows every text
+    return FindIgnoreCasePadded(Text(m_docs[slot]), needleLower) != std::string_view::npos;
+}
+
+void SearchIndex::ScanText(std::string_view needleLower, std::vector<uint32_t>& out) const {
+    // The NUL between documents keeps a match from spanning two of them, and
+    // the vector loop runs through short names instead of stopping at each.
+    // Hits come in buffer order, so walking the extents beats a binary search.
+    const std::string_view text(m_text.data(), TextEnd());
+    auto extent = m_extents.begin();
+    for (size_t pos = 0; pos < text.size(); ++extent) {
+        size_t hit = FindIgnoreCase(text.substr(pos), needleLower);
+        if (hit == std::string_view::npos) break;
+        hit += pos;
+        while (static_cast<size_t>(extent->offset) + extent->length < hit) ++extent;
+        if (m_docs[extent->slot].gen == extent->gen) out.push_back(extent->slot);
+        // One hit per document is enough
+        pos = static_cast<size_t>(extent->offset) + extent->length + 1;
+    }
+}
+
+const SearchIndex::PostingList* SearchIndex::ShortestList(std::string_view s) const {
+    const PostingList* best = nullptr;
+    for (size_t i = 0; i + 3 <= s.size(); ++i) {
+        auto it = m_postings.find(Trigram(s.data() + i));
+        if (it == m_postings.end()) return nullptr;
+        if (!best || it->second.size() < best->size()) best = &it->second;
+    }
+    return best;
+}
+
+void SearchIndex::FindSubstring(std::string_view needleLower, std::vector<uint32_t>& out) const {
+    out.clear();
+    const PostingList* list = nullptr;
+    if (needleLower.size() >= 3) {
+        list = ShortestList(needleLower);
+        if (!list) return;
+    }
+    if (!list || list->size() > m_slotByPid.size() / ScanFraction) {
+        // Too short for trigrams, or a common one
+        ScanText(needleLower, out);
+    } else {
+        for (const Posting& p : *list) {
+            if (IsCurrent(p) && Contains(p.slot, needleLower)) out.push_back(p.slot);
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+void SearchIndex::FindFuzzy(std::string_view queryLower, std::vector<FuzzyMatch>& out) const {
+    out.clear();
+    std::vector<uint32_t> trigrams;
+    Trigrams(queryLower, trigrams);
+    if (trigrams.size() < 2) {
+        std::vector<uint32_t> slots;
+        FindSubstring(queryLower, slots);
+        for (uint32_t slot : slots) out.push_back(FuzzyMatch{1.0f, m_docs[slot].length, slot});
+        std::sort(out.begin(), out.end());
+        return;
+    }
+
+    std::vector<uint16_t> hits(m_docs.size(), 0);
+    std::vector<uint32_t> touched;
+    for (uint32_t t : trigrams) {
+        auto it = m_postings.find(t);
+        if (it == m_postings.end()) continue;
+        for (const Posting& p : it->second) {
+            if (IsCurrent(p) && hits[p.slot]++ == 0) touched.push_back(p.slot);
+        }
+    }
+
+    const size_t needed = (trigrams.size() + 1) / 2;
+    for (uint32_t slot : touched) {
+        if (hits[slot] < needed) continue;
+        float score = static_cast<float>(hits[slot]) / static_cast<float>(trigrams.size());
+        if (Contains(slot, queryLower)) score += 1.0f;
+        out.push_back(FuzzyMatch{score, m_docs[slot].length, slot});
+    }
+    std::sort(out.begin(), out.end());
+}
+
+bool SearchIndex::ScoreFuzzy(uint32_t slot, std::string_view queryLower, FuzzyMatch& out) const {
+    if (slot >= m_docs.size() || !m_docs[slot].live) return false;
+    const Doc& doc = m_docs[slot];
+    const bool exact = Contains(slot, queryLower);
+    std::vector<uint32_t> trigrams;
+    Trigrams(queryLower, trigrams);
+    if (trigrams.size() < 2) {
+        out = FuzzyMatch{1.0f, doc.length, slot};
+        return exact;
+    }
+    // The same count FindFuzzy() gets from the posting lists
+    size_t hits = 0;
+    for (uint32_t t : trigrams) {
+        const char gram[3] = {static_cast<char>(t >> 16), static_cast<char>(t >> 8), static_cast<char>(t)};
+        hits += FindIgnoreCasePadded(Text(doc), std::string_view(gram, 3)) != std::string_view::npos;
+    }
+    if (hits < (trigrams.size() + 1) / 2) return false;
+    float score = static_cast<float>(hits) / static_cast<float>(trigrams.size());
+    if (exact) score += 1.0f;
+    out = FuzzyMatch{score, doc.length, slot};
+    return true;
+}
+
+bool SearchIndex::CompileRegex(const std::string& pattern, RegexQuery& out, std::string& error) {
+    try {
+        out.re.assign(pattern, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+    } catch (const std::regex_error& e) {
+        error = RegexErrorText(e.code());
+        return false;
+    }
+    out.literals.clear();
+    RequiredLiterals(pattern, out.literals);
+    return true;
+}
+
+bool SearchIndex::MatchesRegex(uint32_t slot, const RegexQuery& query) const {
+    if (slot >= m_docs.size() || !m_docs[slot].live) return false;
+    const Doc& doc = m_docs[slot];
+    for (const auto& lit : query.literals) {
+        if (FindIgnoreCasePadded(Text(doc), lit) == std::string_view::npos) return false;
+    }
+    // Match fields separately so ^ and $ anchor to the name or command line
+    std::string_view text = Text(doc);
+    text.remove_prefix(text.find('\n') + 1);
+    while (true) {
+        size_t end = text.find('\n');
+        std::string_view field = text.substr(0, end);
+        if (std::regex_search(field.begin(), field.end(), query.re)) return true;
+        if (end == std::string_view::npos) return false;
+        text.remove_prefix(end + 1);
+    }
+}
+
+void SearchIndex::FindRegex(const RegexQuery& query, std::vector<uint32_t>& out) const {
+    out.clear();
+    const PostingList* shortest = nullptr;
+    for (const auto& lit : query.literals) {
+        const PostingList* list = ShortestList(lit);
+        if (!list) return; // a required literal occurs nowhere
+        if (!shortest || list->size() < shortest->size()) shortest = list;
+    }
+
+    if (shortest) {
+        for (const Posting& p : *shortest) {
+            if (IsCurrent(p) && MatchesRegex(p.slot, query)) out.push_back(p.slot);
+        }
+        std::sort(out.begin(), out.end());
+    } else {
+        for (uint32_t slot = 0; slot < m_docs.size(); ++slot) {
+            if (MatchesRegex(slot, query)) out.push_back(slot);
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "ProcessTable.h"
+#include "SubstringSearch.h"
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class SearchMode { Substring, Fuzzy, Regex };
+
+// Trigram index over the searchable text of every process: pid, name and
+// command line, lowercased and joined by newlines. Documents are keyed by
+// ProcessTable slot and follow the table's add/remove deltas, so a command
+// line is read and indexed once per process lifetime.
+//
+// Each trigram maps to an append-only posting list of (slot, generation)
+// pairs. Removing a document only bumps its generation; stale postings are
+// skipped by queries and swept out once they outnumber live ones. A query
+// walks the shortest posting list among its trigrams and verifies each
+// candidate against the document text, so lists are never intersected.
+//
+// Document texts live back to back in one buffer, each followed by a NUL and
+// the whole followed by SearchPadding bytes. Verifying a short document can
+// then use the padded vector kernel, and a query whose trigrams are common
+// (or too short to have any) scans the buffer in one pass instead of
+// document by document. Removed texts are swept like stale postings.
+//
+// Every Add/Remove also logs its slot, so a caller holding results for an
+// older Version() can re-test just the slots that changed (ChangedSince())
+// with the per-document tests instead of running the query again.
+class SearchIndex {
+public:
+    // One fuzzy result. Sorting puts the best first: higher score, then the
+    // shorter (tighter) text, then slot order.
+    struct FuzzyMatch {
+        float score; // share of the query's trigrams present, +1 for an exact substring
+        uint32_t length;
+        uint32_t slot;
+
+        bool operator<(const FuzzyMatch& o) const {
+            if (score != o.score) return score > o.score;
+            if (length != o.length) return length < o.length;
+            return slot < o.slot;
+        }
+    };
+
+    // A compiled regex query; reusable for as long as the pattern is
+    struct RegexQuery {
+        std::regex re;
+        std::vector<std::string> literals; // runs every match must contain, lowercased
+    };
+
+    // Replaces whatever was indexed for key.pid
+    void Add(uint32_t slot, const ProcessKey& key, StringPool::Id nameId, std::string_view pidText,
+             std::string_view name, std::string_view cmdline);
+    void Remove(const ProcessKey& key);
+
+    // True if key is indexed under this name; a new name means an exec
+    bool IsIndexed(const ProcessKey& key, StringPool::Id nameId) const;
+
+    // Case-insensitive substring; needleLower must be lowercase. Slot order.
+    void FindSubstring(std::string_view needleLower, std::vector<uint32_t>& out) const;
+    bool Contains(uint32_t slot, std::string_view needleLower) const;
+
+    // Documents sharing at least half of the query's trigrams, best first.
+    // Exact substring hits rank above partial ones. Tolerates typos. Queries
+    // too short for two trigrams take substring hits only.
+    void FindFuzzy(std::string_view queryLower, std::vector<FuzzyMatch>& out) const;
+    // slot's entry in FindFuzzy()'s results, or false if it has none
+    bool ScoreFuzzy(uint32_t slot, std::string_view queryLower, FuzzyMatch& out) const;
+
+    // Case-insensitive ECMAScript regex, applied to the name and command line
+    // separately. Literal runs the pattern requires are used as a trigram
+    // prefilter. Compile returns false with a message if the pattern is invalid.
+    static bool CompileRegex(const std::string& pattern, RegexQuery& out, std::string& error);
+    void FindRegex(const RegexQuery& query, std::vector<uint32_t>& out) const;
+    bool MatchesRegex(uint32_t slot, const RegexQuery& query) const;
+
+    // Bumped on every Add/Remove
+    uint64_t Version() const { return m_version; }
+    // Appends the slots added or removed since version (possibly repeated).
+    // False if that is further back than the log goes; re-run the query then.
+    bool ChangedSince(uint64_t version, std::vector<uint32_t>& out) const;
+    size_t Size() const { return m_slotByPid.size(); }
+    size_t TextBytes() const { return m_textBytes; }
+    size_t TrigramCount() const { return m_postings.size(); }
+
+private:
+    struct Doc {
+        ProcessKey key;
+        StringPool::Id nameId = StringPool::EmptyId;
+        uint32_t gen = 0;
+        bool live = false;
+        uint32_t postings = 0;
+        uint32_t offset = 0; // text in m_text
+        uint32_t length = 0;
+    };
+
+    // Where a document's text sits in m_text; in buffer order
+    struct Extent {
+        uint32_t offset;
+        uint32_t length;
+        uint32_t slot;
+        uint32_t gen; // stale once the document's generation moved on
+    };
+
+    struct Posting {
+        uint32_t slot;
+        uint32_t gen;
+    };
+
+    using PostingList = std::vector<Posting>;
+
+    bool IsCurrent(const Posting& p) const { return m_docs[p.slot].gen == p.gen; }
+    std::string_view Text(const Doc& doc) const { return {m_text.data() + doc.offset, doc.length}; }
+    size_t TextEnd() const { return m_text.empty() ? 0 : m_text.size() - SearchPadding; }
+    void RemoveSlot(uint32_t slot);
+    void Touch(uint32_t slot);
+    // Every live document containing needleLower, in one pass over m_text
+    void ScanText(std::string_view needleLower, std::vector<uint32_t>& out) const;
+    void CompactText();
+    // Shortest posting list over the trigrams of s (size >= 3); nullptr if
+    // some trigram occurs nowhere, so nothing can match.
+    const PostingList* ShortestList(std::string_view s) const;
+    void Compact();
+
+    std::vector<Doc> m_docs; // indexed by slot
+    std::string m_text;
+    std::vector<Extent> m_extents;
+    size_t m_deadTextBytes = 0;
+    std::unordered_map<int, uint32_t> m_slotByPid;
+    std::unordered_map<uint32_t, PostingList> m_postings;
+    std::vector<uint32_t> m_trigramScratch;
+    size_t m_livePostings = 0;
+    size_t m_deadPostings = 0;
+    size_t m_textBytes = 0;
+    uint64_t m_version = 0;
+    std::vector<uint32_t> m_changeLog; // slot changed by each version after m_changeLogBase
+    uint64_t m_changeLogBase = 0;
+};
@@ -0,0 +1,22 @@
+#include "SeriesHistory.h"
+
+#include <algorithm>
+
+void SeriesHistory::Reset(size_t series, size_t length) {
+    m_series = series;
+    m_length = length;
+    m_size = 0;
+    m_head = 0;
+    m_data.assign(series * length, 0.0f);
+    ++m_version;
+}
+
+void SeriesHistory::Push(const float* values) {
+    if (m_length == 0) return;
+    for (size_t s = 0; s < m_series; ++s) {
+        m_data[s * m_length + m_head] = values[s];
+    }
+    m_head = (m_head + 1) % m_length;
+    m_size = std::min(m_size + 1, m_length);
+    ++m_version;
+}
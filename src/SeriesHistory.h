@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A fixed number of float series sampled together, stored column by column:
+// each series is its own contiguous ring of Length() values. A tick writes
+// one value per series at the same ring position, so a new series adds one
+// store per sample and a reader (a plot of one series, or a stack of several)
+// walks each series sequentially. CoreHistory is the row-major counterpart,
+// for when a whole sample is read at once.
+class SeriesHistory {
+public:
+    // Drops all samples
+    void Reset(size_t series, size_t length);
+
+    // Appends one sample: values[s] is series s's value
+    void Push(const float* values);
+
+    size_t SeriesCount() const { return m_series; }
+    size_t Length() const { return m_length; }
+    size_t Size() const { return m_size; } // samples held, up to Length()
+
+    // Sample i of series s, 0 = oldest
+    float Value(size_t s, size_t i) const {
+        return m_data[s * m_length + (m_head + m_length - m_size + i) % m_length];
+    }
+
+    // Bumped by every Push() and Reset(), so copies can be skipped when unchanged
+    uint64_t Version() const { return m_version; }
+
+private:
+    size_t m_series = 0;
+    size_t m_length = 0;
+    size_t m_size = 0;
+    size_t m_head = 0; // position the next Push() writes in every series
+    uint64_t m_version = 0;
+    std::vector<float> m_data;
+};
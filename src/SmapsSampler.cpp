@@ -0,0 +1,229 @@
+#include "SmapsSampler.h"
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Value in kB of a "Name:   123 kB" line, if the line is exactly that field
+bool FieldKb(const char* line, const char* end, const char* name, uint64_t& out) {
+    const size_t n = std::strlen(name);
+    if (static_cast<size_t>(end - line) <= n || std::memcmp(line, name, n) != 0 || line[n] != ':') return false;
+    uint64_t v = 0;
+    for (const char* p = line + n + 1; p < end; ++p) {
+        if (*p >= '0' && *p <= '9') v = v * 10 + static_cast<uint64_t>(*p - '0');
+        else if (v != 0 || *p != ' ') break;
+    }
+    out = v * 1024;
+    return true;
+}
+} // namespace
+
+bool ParseSmapsRollup(const char* text, size_t len, SmapsSample& out) {
+    uint64_t privateClean = 0;
+    uint64_t privateDirty = 0;
+    bool havePss = false;
+    const char* end = text + len;
+    for (const char* line = text; line < end;) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (!eol) eol = end;
+        // The first line is the address range; fields follow, one per line
+        havePss |= FieldKb(line, eol, "Pss", out.pssBytes);
+        FieldKb(line, eol, "Private_Clean", privateClean);
+        FieldKb(line, eol, "Private_Dirty", privateDirty);
+        FieldKb(line, eol, "Swap", out.swapBytes);
+        line = eol + 1;
+    }
+    out.ussBytes = privateClean + privateDirty;
+    return havePss;
+}
+
+#if defined(__linux__)
+namespace {
+constexpr size_t PriorityCount = 64;
+// Claim = rss * age / AgeTicks + MovedWeight * |rss change since last sample|
+constexpr double AgeTicks = 10.0;
+constexpr double MovedWeight = 4.0;
+} // namespace
+
+SmapsSampler::SmapsSampler(std::chrono::microseconds budget) : m_budget(budget) {
+    m_thread = std::thread(&SmapsSampler::Run, this);
+}
+
+SmapsSampler::~SmapsSampler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void SmapsSampler::SetBudget(std::chrono::microseconds budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+}
+
+void SmapsSampler::Submit(std::vector<Candidate>& candidates) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // A tick still in progress just misses this submission
+        m_pending.swap(candidates);
+        m_hasWork = true;
+    }
+    m_cv.notify_all();
+}
+
+void SmapsSampler::TakeResults(std::vector<SmapsSample>& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out.insert(out.end(), m_results.begin(), m_results.end());
+    m_results.clear();
+}
+
+size_t SmapsSampler::LastTickSamples() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastSamples;
+}
+
+float SmapsSampler::LastTickMs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastMs;
+}
+
+void SmapsSampler::Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [&] { return m_stop || m_hasWork; });
+        if (m_stop) return;
+        m_candidates.swap(m_pending);
+        m_hasWork = false;
+        lock.unlock();
+        SampleTick();
+        lock.lock();
+    }
+}
+
+void SmapsSampler::SampleTick() {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    std::chrono::microseconds budget;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        budget = m_budget;
+    }
+    ++m_tick;
+    m_tickResults.clear();
+    m_readThisTick.assign(m_candidates.size(), 0);
+
+    auto read = [&](size_t i) {
+        const Candidate& c = m_candidates[i];
+        m_readThisTick[i] = 1;
+        SmapsSample sample;
+        State& s = m_state[c.key];
+        bool denied = false;
+        if (ReadOne(c.key, sample, denied)) {
+            s.sampledRss = c.rssBytes;
+            s.lastTick = m_tick;
+            m_tickResults.push_back(sample);
+        }
+        s.denied = denied; // needs ptrace access; don't keep trying
+    };
+
+    // Strongest claims, through a bounded min-heap
+    struct Claim {
+        double score;
+        uint32_t index;
+    };
+    auto stronger = [](const Claim& a, const Claim& b) { return a.score > b.score; };
+    std::vector<Claim> claims;
+    claims.reserve(PriorityCount);
+    for (uint32_t i = 0; i < m_candidates.size(); ++i) {
+        const Candidate& c = m_candidates[i];
+        if (c.rssBytes == 0) continue; // kernel threads have no user memory
+        State& s = m_state[c.key];
+        s.seenTick = m_tick;
+        if (s.denied) continue;
+        const double rss = static_cast<double>(c.rssBytes);
+        double score;
+        if (s.lastTick == 0) {
+            score = 1e30 + rss; // never sampled: first, largest first
+        } else {
+            const double moved = std::abs(rss - static_cast<double>(s.sampledRss));
+            score = rss * static_cast<double>(m_tick - s.lastTick) / AgeTicks + MovedWeight * moved;
+        }
+        if (claims.size() < PriorityCount) {
+            claims.push_back(Claim{score, i});
+            std::push_heap(claims.begin(), claims.end(), stronger);
+        } else if (score > claims.front().score) {
+            std::pop_heap(claims.begin(), claims.end(), stronger);
+            claims.back() = Claim{score, i};
+            std::push_heap(claims.begin(), claims.end(), stronger);
+        }
+    }
+    std::sort_heap(claims.begin(), claims.end(), stronger);
+
+    // A read that starts within the budget is allowed to finish
+    const Clock::time_point priorityEnd = start + budget * 3 / 4;
+    const Clock::time_point end = start + budget;
+    for (const Claim& claim : claims) {
+        if (Clock::now() >= priorityEnd) break;
+        read(claim.index);
+    }
+
+    // Round-robin over everything else, resuming where the last tick stopped
+    const size_t n = m_candidates.size();
+    size_t pos = static_cast<size_t>(
+        std::lower_bound(m_candidates.begin(), m_candidates.end(), m_cursor,
+                         [](const Candidate& c, uint32_t slot) { return c.slot < slot; }) -
+        m_candidates.begin());
+    for (size_t visited = 0; visited < n; ++visited, ++pos) {
+        if (pos >= n) pos = 0;
+        const Candidate& c = m_candidates[pos];
+        if (m_readThisTick[pos] || c.rssBytes == 0 || m_state[c.key].denied) continue;
+        if (Clock::now() >= end) break;
+        read(pos);
+        m_cursor = c.slot + 1;
+    }
+
+    // Forget processes that are gone
+    for (auto it = m_state.begin(); it != m_state.end();) {
+        it = it->second.seenTick == m_tick ? std::next(it) : m_state.erase(it);
+    }
+
+    std::chrono::duration<float, std::milli> elapsed = Clock::now() - start;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results.insert(m_results.end(), m_tickResults.begin(), m_tickResults.end());
+    m_lastSamples = m_tickResults.size();
+    m_lastMs = elapsed.count();
+}
+
+bool SmapsSampler::ReadOne(const ProcessKey& key, SmapsSample& out, bool& denied) {
+    char path[48];
+    std::snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", key.pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        denied = errno == EACCES;
+        return false;
+    }
+    m_buffer.resize(4096);
+    size_t len = 0;
+    while (len < m_buffer.size()) {
+        ssize_t n = read(fd, m_buffer.data() + len, m_buffer.size() - len);
+        if (n <= 0) break;
+        len += static_cast<size_t>(n);
+    }
+    close(fd);
+    // If the pid was reused since the scan, the table no longer holds this
+    // key and the sample is dropped when applied
+    out.key = key;
+    return ParseSmapsRollup(m_buffer.data(), len, out);
+}
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ProcessTable.h"
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__linux__)
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#endif
+
+// Proportional / unique memory of one process from /proc/<pid>/smaps_rollup
+struct SmapsSample {
+    ProcessKey key;
+    uint64_t pssBytes = 0;
+    uint64_t ussBytes = 0; // private clean + private dirty
+    uint64_t swapBytes = 0;
+};
+
+// Parses the text of a smaps_rollup file. Returns false if no Pss line was found.
+bool ParseSmapsRollup(const char* text, size_t len, SmapsSample& out);
+
+#if defined(__linux__)
+// Background PSS/USS/swap collector. smaps_rollup makes the kernel walk a
+// process's page tables, which costs milliseconds for large processes, so
+// each tick only reads as many as fit in a time budget, on its own thread:
+//
+//  - Up to 3/4 of the budget goes to the processes with the strongest claim,
+//    which grows with RSS, with how far RSS moved since the last sample and
+//    with the time since then; processes never sampled come first.
+//  - The rest continues a round-robin walk over all processes, so every one
+//    is eventually covered however small.
+//
+// The owner submits the live processes once per tick and collects finished
+// samples on the next one.
+class SmapsSampler {
+public:
+    struct Candidate {
+        ProcessKey key;
+        uint32_t slot = 0; // ascending; the round-robin cursor follows it
+        uint64_t rssBytes = 0;
+    };
+
+    explicit SmapsSampler(std::chrono::microseconds budget = std::chrono::milliseconds(5));
+    ~SmapsSampler();
+
+    SmapsSampler(const SmapsSampler&) = delete;
+    SmapsSampler& operator=(const SmapsSampler&) = delete;
+
+    void SetBudget(std::chrono::microseconds budget);
+
+    // Hands over this tick's processes (in slot order) and wakes the thread.
+    // candidates is swapped with the previous tick's buffer, not copied.
+    void Submit(std::vector<Candidate>& candidates);
+
+    // Appends the samples finished since the last call
+    void TakeResults(std::vector<SmapsSample>& out);
+
+    // Samples read and time spent by the last completed tick
+    size_t LastTickSamples() const;
+    float LastTickMs() const;
+
+private:
+    struct State {
+        uint64_t sampledRss = 0;
+        uint64_t lastTick = 0; // tick of the last sample
+        uint64_t seenTick = 0;
+        bool denied = false;
+    };
+
+    void Run();
+    void SampleTick();
+    bool ReadOne(const ProcessKey& key, SmapsSample& out, bool& denied);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::chrono::microseconds m_budget;
+    std::vector<Candidate> m_pending;
+    bool m_hasWork = false;
+    bool m_stop = false;
+    std::vector<SmapsSample> m_results;
+    size_t m_lastSamples = 0;
+    float m_lastMs = 0.0f;
+
+    // Sampler thread only
+    std::vector<Candidate> m_candidates;
+    std::vector<uint8_t> m_readThisTick;
+    std::unordered_map<ProcessKey, State, ProcessKeyHash> m_state;
+    std::vector<SmapsSample> m_tickResults;
+    std::string m_buffer;
+    uint64_t m_tick = 0;
+    uint32_t m_cursor = 0; // next slot for the round-robin walk
+
+    std::thread m_thread;
+};
+#endif
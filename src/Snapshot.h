@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+// The latest immutable T, replaced whole by one writer and read by any
+// number of threads. Neither side ever waits on the other for longer than a
+// reference count update: readers keep the object they loaded alive after
+// the writer moves on, and the writer never touches a published object again.
+// Compare versions or pointers to tell that nothing changed.
+template <typename T>
+class Snapshot {
+public:
+    std::shared_ptr<const T> Load() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return m_value.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&m_value, std::memory_order_acquire);
+#endif
+    }
+
+    void Store(std::shared_ptr<const T> value) {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        m_value.store(std::move(value), std::memory_order_release);
+#else
+        std::atomic_store_explicit(&m_value, std::move(value), std::memory_order_release);
+#endif
+    }
+
+private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<const T>> m_value;
+#else
+    std::shared_ptr<const T> m_value;
+#endif
+};
@@ -0,0 +1,46 @@
+#include "StringPool.h"
+
+#include <cstring>
+
+StringPool::StringPool() {
+    Intern({});
+}
+
+StringPool::Id StringPool::Intern(std::string_view s) {
+    auto it = m_index.find(s);
+    if (it != m_index.end()) return it->second;
+
+    // Original and lowercase copies sit back to back, each NUL-terminated
+    char* str = Allocate(2 * (s.size() + 1));
+    char* lower = str + s.size() + 1;
+    std::memcpy(str, s.data(), s.size());
+    str[s.size()] = '\0';
+    for (size_t i = 0; i < s.size(); ++i) {
+        char c = s[i];
+        lower[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    lower[s.size()] = '\0';
+
+    Id id = static_cast<Id>(m_entries.size());
+    Entry e{{str, s.size()}, {lower, s.size()}};
+    m_entries.push_back(e);
+    m_index.emplace(e.str, id);
+    return id;
+}
+
+char* StringPool::Allocate(size_t bytes) {
+    if (bytes > ChunkBytes) {
+        // Oversized strings get a dedicated block; the current chunk stays open
+        m_large.push_back(std::make_unique<char[]>(bytes));
+        m_bytes += bytes;
+        return m_large.back().get();
+    }
+    if (m_chunkUsed + bytes > ChunkBytes) {
+        m_chunks.push_back(std::make_unique<char[]>(ChunkBytes));
+        m_chunkUsed = 0;
+        m_bytes += ChunkBytes;
+    }
+    char* p = m_chunks.back().get() + m_chunkUsed;
+    m_chunkUsed += bytes;
+    return p;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Append-only string interner. Every distinct string gets a stable 4-byte id
+// and is stored once, NUL-terminated, next to a precomputed lowercase copy.
+// Storage grows in fixed chunks, so returned views and pointers stay valid for
+// the lifetime of the pool. Nothing is ever removed: process names repeat
+// heavily, so the pool stays small even as processes come and go.
+class StringPool {
+public:
+    using Id = uint32_t;
+
+    // Id of the empty string, interned up front
+    static constexpr Id EmptyId = 0;
+
+    StringPool();
+
+    Id Intern(std::string_view s);
+
+    std::string_view Get(Id id) const { return m_entries[id].str; }
+    std::string_view GetLower(Id id) const { return m_entries[id].lower; }
+    const char* CStr(Id id) const { return m_entries[id].str.data(); }
+
+    // Number of distinct strings and bytes held in chunks
+    size_t Size() const { return m_entries.size(); }
+    size_t Bytes() const { return m_bytes; }
+
+private:
+    static constexpr size_t ChunkBytes = 64 * 1024;
+
+    struct Entry {
+        std::string_view str;
+        std::string_view lower;
+    };
+
+    char* Allocate(size_t bytes);
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    std::vector<std::unique_ptr<char[]>> m_large;
+    size_t m_chunkUsed = ChunkBytes;
+    size_t m_bytes = 0;
+    std::vector<Entry> m_entries;
+    std::unordered_map<std::string_view, Id> m_index;
+};
@@ -0,0 +1,171 @@
+#include "SubstringSearch.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SUBSTRING_SEARCH_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 is compiled per function and only called after a CPUID check
+#define SUBSTRING_SEARCH_AVX2 1
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+constexpr size_t npos = std::string_view::npos;
+
+inline char FoldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+inline bool EqualsFolded(const char* h, const char* needleLower, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (FoldAscii(h[i]) != needleLower[i]) return false;
+    }
+    return true;
+}
+
+[[maybe_unused]] inline unsigned LowestBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+size_t FindScalar(std::string_view h, std::string_view n, size_t from = 0) {
+    if (n.size() > h.size()) return npos;
+    const char first = n[0];
+    for (size_t i = from, last = h.size() - n.size(); i <= last; ++i) {
+        if (FoldAscii(h[i]) == first && EqualsFolded(h.data() + i + 1, n.data() + 1, n.size() - 1)) return i;
+    }
+    return npos;
+}
+
+// OR-ing 0x20 maps 'A'..'Z' onto 'a'..'z' and no other byte onto a letter,
+// so it is an exact fold as long as it is only applied for letter needles.
+inline char CaseBit(char lower) {
+    return (lower >= 'a' && lower <= 'z') ? 0x20 : 0;
+}
+
+SearchKernel DetectKernel() {
+#if defined(SUBSTRING_SEARCH_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SearchKernel::Avx2;
+#endif
+#if defined(SUBSTRING_SEARCH_X86)
+    return SearchKernel::Sse2; // part of the x86-64 baseline
+#else
+    return SearchKernel::Scalar;
+#endif
+}
+
+const SearchKernel g_bestKernel = DetectKernel();
+
+// Padded: the caller guarantees SearchPadding readable bytes past the end,
+// so the last block is loaded whole and lanes past the final start masked off
+#ifdef SUBSTRING_SEARCH_X86
+template <bool Padded>
+size_t FindSse2(std::string_view h, std::string_view n) {
+    const size_t k = n.size();
+    if (k > h.size()) return npos;
+    const __m128i first = _mm_set1_epi8(n[0]);
+    const __m128i lastCh = _mm_set1_epi8(n[k - 1]);
+    const __m128i firstFold = _mm_set1_epi8(CaseBit(n[0]));
+    const __m128i lastFold = _mm_set1_epi8(CaseBit(n[k - 1]));
+    const size_t starts = h.size() - k + 1;
+
+    size_t i = 0;
+    for (; Padded ? i < starts : i + 16 <= starts; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h.data() + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h.data() + i + k - 1));
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(a, firstFold), first),
+                                    _mm_cmpeq_epi8(_mm_or_si128(b, lastFold), lastCh));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (Padded && starts - i < 16) mask &= (1u << (starts - i)) - 1;
+        while (mask) {
+            size_t pos = i + LowestBit(mask);
+            if (EqualsFolded(h.data() + pos + 1, n.data() + 1, k - 1)) return pos;
+            mask &= mask - 1;
+        }
+    }
+    return Padded ? npos : FindScalar(h, n, i);
+}
+#endif
+
+#ifdef SUBSTRING_SEARCH_AVX2
+template <bool Padded>
+__attribute__((target("avx2"))) size_t FindAvx2(std::string_view h, std::string_view n) {
+    const size_t k = n.size();
+    if (k > h.size()) return npos;
+    const __m256i first = _mm256_set1_epi8(n[0]);
+    const __m256i lastCh = _mm256_set1_epi8(n[k - 1]);
+    const __m256i firstFold = _mm256_set1_epi8(CaseBit(n[0]));
+    const __m256i lastFold = _mm256_set1_epi8(CaseBit(n[k - 1]));
+    const size_t starts = h.size() - k + 1;
+
+    size_t i = 0;
+    for (; Padded ? i < starts : i + 32 <= starts; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h.data() + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h.data() + i + k - 1));
+        __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_or_si256(a, firstFold), first),
+                                       _mm256_cmpeq_epi8(_mm256_or_si256(b, lastFold), lastCh));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (Padded && starts - i < 32) mask &= (1u << (starts - i)) - 1;
+        while (mask) {
+            size_t pos = i + LowestBit(mask);
+            if (EqualsFolded(h.data() + pos + 1, n.data() + 1, k - 1)) return pos;
+            mask &= mask - 1;
+        }
+    }
+    return Padded ? npos : FindScalar(h, n, i);
+}
+#endif
+
+template <bool Padded>
+size_t Dispatch(SearchKernel kernel, std::string_view haystack, std::string_view needleLower) {
+    if (needleLower.empty()) return 0;
+#ifdef SUBSTRING_SEARCH_AVX2
+    if (kernel == SearchKernel::Avx2 && g_bestKernel == SearchKernel::Avx2) {
+        return FindAvx2<Padded>(haystack, needleLower);
+    }
+#endif
+#ifdef SUBSTRING_SEARCH_X86
+    if (kernel != SearchKernel::Scalar) return FindSse2<Padded>(haystack, needleLower);
+#endif
+    (void)kernel;
+    return FindScalar(haystack, needleLower);
+}
+} // namespace
+
+SearchKernel BestSearchKernel() {
+    return g_bestKernel;
+}
+
+const char* SearchKernelName(SearchKernel kernel) {
+    switch (kernel) {
+    case SearchKernel::Avx2: return "avx2";
+    case SearchKernel::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+size_t FindIgnoreCase(std::string_view haystack, std::string_view needleLower) {
+    return FindIgnoreCase(g_bestKernel, haystack, needleLower);
+}
+
+size_t FindIgnoreCase(SearchKernel kernel, std::string_view haystack, std::string_view needleLower) {
+    return Dispatch<false>(kernel, haystack, needleLower);
+}
+
+size_t FindIgnoreCasePadded(std::string_view haystack, std::string_view needleLower) {
+    return Dispatch<true>(g_bestKernel, haystack, needleLower);
+}
+
+size_t FindIgnoreCasePadded(SearchKernel kernel, std::string_view haystack, std::string_view needleLower) {
+    return Dispatch<true>(kernel, haystack, needleLower);
+}
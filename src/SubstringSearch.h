@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// ASCII case-insensitive substring search used by the process filter.
+// Candidates are found by comparing the needle's first and last bytes against
+// 16 (SSE2) or 32 (AVX2) haystack positions at once, then confirmed with a
+// short scalar compare. The widest kernel the CPU supports is picked once at
+// startup; other architectures use the scalar loop.
+enum class SearchKernel { Scalar, Sse2, Avx2 };
+
+// Best kernel available on this machine
+SearchKernel BestSearchKernel();
+const char* SearchKernelName(SearchKernel kernel);
+
+// Position of the first case-insensitive match of needleLower in haystack,
+// or npos. The needle must already be lowercase; the haystack may be mixed.
+size_t FindIgnoreCase(std::string_view haystack, std::string_view needleLower);
+
+// Same, with an explicit kernel (for benchmarks). The kernel must be
+// supported by this CPU; unavailable ones fall back to scalar.
+size_t FindIgnoreCase(SearchKernel kernel, std::string_view haystack, std::string_view needleLower);
+
+// Bytes past the end of the haystack that the padded variants may read
+constexpr size_t SearchPadding = 32;
+
+// FindIgnoreCase for a haystack followed by at least SearchPadding readable
+// bytes (of any value). The last vector load runs past the end and its
+// out-of-range lanes are masked off, so strings shorter than one vector,
+// like process names, take the vector path instead of the scalar tail.
+size_t FindIgnoreCasePadded(std::string_view haystack, std::string_view needleLower);
+size_t FindIgnoreCasePadded(SearchKernel kernel, std::string_view haystack, std::string_view needleLower);
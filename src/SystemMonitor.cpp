@@ -1,8 +1,11 @@
 #include "SystemMonitor.h"
 
+#include "SubstringSearch.h"
+
 #include <cstring>
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <cstdio>
 #include <sstream>
 
@@ -23,9 +26,9 @@
 #include <fstream>
 #else
 #include <sys/sysinfo.h>
+#include <unistd.h>
 #include <signal.h>
 #include <dirent.h>
-#include <fstream>
 #endif
 
 using json = nlohmann::json;
@@ -39,26 +42,60 @@ size_t CurlWriteCallback(void* contents, size_t size, size_t nmemb, void* userp)
     return total;
 }
 
-static std::string toLower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(),
-                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    return s;
+// Non-Linux backends only know a pid, parent and name; those double as the change hash.
+[[maybe_unused]] void FillRecordName(ProcStatRecord& rec, const char* name, size_t len) {
+    if (len >= sizeof(rec.comm)) len = sizeof(rec.comm) - 1;
+    std::memcpy(rec.comm, name, len);
+    rec.comm[len] = '\0';
+    rec.commLen = static_cast<int>(len);
+    rec.statHash = HashBytes(name, len) ^ static_cast<uint64_t>(static_cast<unsigned>(rec.ppid));
+}
+
+// A broad pattern ("a") must not turn the pin sampler into a second full scan
+[[maybe_unused]] constexpr size_t MaxPatternPins = 64;
+
+bool PinnedKeyLess(const ProcessKey& a, const ProcessKey& b) {
+    return a.pid != b.pid ? a.pid < b.pid : a.startTime < b.startTime;
+}
+
+// Pin patterns match case-insensitively and are stored lowercased
+std::string LowercasePattern(const std::string& pattern) {
+    std::string lower = pattern;
+    for (char& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return lower;
 }
 } // namespace
 
 SystemMonitor::SystemMonitor() {
-    m_cpuHistory.reserve(MaxHistory);
-#ifdef _WIN32
+    ResetHistory(DefaultSampleRateHz);
+#if defined(__linux__)
+    ResetStatWindow(DefaultSampleRateHz);
+#endif
     // Prime CPU timing info
-    SampleCpuUsage();
-#else
-    SampleCpuUsage();
+    SampleCpuUsage(std::chrono::steady_clock::now());
+#if defined(__linux__)
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize > 0) m_processTable.SetPageSize(static_cast<uint64_t>(pageSize));
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0) m_cpuCount = static_cast<unsigned int>(cpus);
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) m_clockTicksPerSecond = static_cast<double>(ticks);
+
+    // Storage I/O per process; other users' processes only show it as root
+    m_procScanner.SetReadIo(true);
+
+    // Optional: needs CAP_NET_ADMIN, otherwise we keep polling /proc
+    m_procEvents.Open();
 #endif
     // Start background weather worker
     m_weatherThread = std::thread(&SystemMonitor::WeatherWorker, this);
 }
 
 SystemMonitor::~SystemMonitor() {
+    m_hwTimer.Cancel();
+    m_procTimer.Cancel();
+    if (m_hwThread.joinable()) m_hwThread.join();
+    if (m_procThread.joinable()) m_procThread.join();
     m_weatherThreadStop.store(true);
     // Wake worker if it's idle by toggling flag
     if (m_weatherThread.joinable()) {
@@ -67,33 +104,480 @@ SystemMonitor::~SystemMonitor() {
 }
 
 void SystemMonitor::Update() {
-    UpdateHardware();
+    UpdateHardware(std::chrono::steady_clock::now());
+    UpdateProcesses();
+    LoadRequestedDetails();
+#if defined(__linux__)
+    ResolvePins();
+#endif
+    PublishProcesses();
+}
 
-    // Refresh process list at a lighter rate if desired
-    {
-        std::lock_guard<std::mutex> lock(m_procMutex);
-        m_processesCache = QueryProcesses();
+void SystemMonitor::StartSampling() {
+    if (m_hwThread.joinable()) return;
+    m_hwThread = std::thread(&SystemMonitor::HardwareLoop, this);
+    m_procThread = std::thread(&SystemMonitor::ProcessLoop, this);
+}
+
+void SystemMonitor::SetSampleRate(unsigned hz) {
+    m_sampleRateHz.store(std::clamp(hz, 1u, MaxSampleRateHz));
+}
+
+void SystemMonitor::HardwareLoop() {
+    unsigned rate = 0;
+    while (true) {
+        const unsigned wanted = m_sampleRateHz.load();
+        if (wanted != rate) {
+            rate = wanted;
+            m_hwTimer.SetRate(rate);
+            // Samples at two rates wouldn't share a time axis
+            m_hwPublished = {};
+            ResetHistory(rate);
+#if defined(__linux__)
+            ResetStatWindow(rate);
+#endif
+        }
+        const uint64_t periods = m_hwTimer.Wait();
+        if (periods == 0) return;
+        UpdateHardware(std::chrono::steady_clock::now(), periods);
     }
 }
 
-HardwareStats SystemMonitor::GetHardwareStats() const {
-    std::lock_guard<std::mutex> lock(m_hwMutex);
-    return m_hwStats;
+void SystemMonitor::ResetHistory(unsigned rateHz) {
+    // HistorySpan of samples, in at most MaxHistoryPoints points
+    const size_t samples = std::max<size_t>(1, static_cast<size_t>(rateHz) * static_cast<size_t>(HistorySpan.count()));
+    m_historyStride = static_cast<unsigned>((samples + MaxHistoryPoints - 1) / MaxHistoryPoints);
+    m_historyLength = (samples + m_historyStride - 1) / m_historyStride;
+    m_cpuHistory.clear();
+    m_cpuHistory.reserve(m_historyLength);
+    ++m_cpuHistoryVersion;
+    m_cpuTimeHistory.Reset(CpuCategoryCount, m_historyLength);
+    m_coreHistory.Reset(m_coreHistory.Cores(), m_historyLength);
+    m_strideSamples = 0;
+    m_strideCpu = 0.0f;
+    std::fill(std::begin(m_strideCpuTimes), std::end(m_strideCpuTimes), 0.0f);
+    std::fill(m_strideCores.begin(), m_strideCores.end(), 0.0f);
 }
 
-std::vector<ProcessInfo> SystemMonitor::GetProcesses(const std::string& filter) const {
-    std::vector<ProcessInfo> result;
-    std::string filterLower = toLower(filter);
+void SystemMonitor::PushHistory(float cpu) {
+    m_strideCpu += cpu;
+    for (int c = 0; c < CpuCategoryCount; ++c) m_strideCpuTimes[c] += m_cpuTimes[c];
+#if !defined(_WIN32) && !defined(__APPLE__)
+    m_strideCores.resize(m_coreUsage.size(), 0.0f);
+    for (size_t i = 0; i < m_coreUsage.size(); ++i) m_strideCores[i] += m_coreUsage[i];
+#endif
+    if (++m_strideSamples < m_historyStride) return;
 
-    std::lock_guard<std::mutex> lock(m_procMutex);
-    for (const auto& p : m_processesCache) {
-        if (filterLower.empty() ||
-            toLower(p.name).find(filterLower) != std::string::npos ||
-            std::to_string(p.pid).find(filterLower) != std::string::npos) {
-            result.push_back(p);
+    // A full stride becomes one point, the mean of its samples
+    const float scale = 1.0f / static_cast<float>(m_strideSamples);
+    if (m_cpuHistory.size() >= m_historyLength) {
+        m_cpuHistory.erase(m_cpuHistory.begin());
+    }
+    m_cpuHistory.push_back(m_strideCpu * scale);
+    ++m_cpuHistoryVersion;
+#if !defined(__APPLE__)
+    for (float& v : m_strideCpuTimes) v *= scale;
+    m_cpuTimeHistory.Push(m_strideCpuTimes);
+#endif
+#if !defined(_WIN32) && !defined(__APPLE__)
+    if (m_coreHistory.Cores() != m_strideCores.size()) {
+        // First sample, or a core came online with a higher number
+        m_coreHistory.Reset(m_strideCores.size(), m_historyLength);
+    }
+    if (!m_strideCores.empty()) {
+        for (float& v : m_strideCores) v *= scale;
+        m_coreHistory.Push(m_strideCores.data());
+    }
+#endif
+    m_strideSamples = 0;
+    m_strideCpu = 0.0f;
+    std::fill(std::begin(m_strideCpuTimes), std::end(m_strideCpuTimes), 0.0f);
+    std::fill(m_strideCores.begin(), m_strideCores.end(), 0.0f);
+}
+
+void SystemMonitor::ProcessLoop() {
+    // Polls kernel process events at this rate; the full scan runs when due
+    m_procTimer.SetRate(ProcPollRateHz);
+    while (m_procTimer.Wait() > 0) {
+        UpdateProcesses();
+        LoadRequestedDetails();
+#if defined(__linux__)
+        ResolvePins();
+#endif
+        PublishProcesses();
+    }
+}
+
+std::shared_ptr<const HardwareSnapshot> SystemMonitor::GetHardware() const {
+    static const auto empty = [] {
+        auto s = std::make_shared<HardwareSnapshot>();
+        s->cpuHistory = std::make_shared<const std::vector<float>>();
+        s->coreHistory = std::make_shared<const CoreHistory>();
+        s->cpuTimeHistory = std::make_shared<const SeriesHistory>();
+        return std::shared_ptr<const HardwareSnapshot>(std::move(s));
+    }();
+    auto snapshot = m_hwSnapshot.Load();
+    return snapshot ? snapshot : empty;
+}
+
+template <typename Fn>
+void SystemMonitor::PostProcessQuery(Fn&& edit) const {
+    std::lock_guard<std::mutex> lock(m_queryMutex);
+    ProcessQuery next = m_query;
+    edit(next);
+    if (next.filter == m_query.filter && next.mode == m_query.mode && next.tree == m_query.tree &&
+        next.topMetric == m_query.topMetric && next.topCount == m_query.topCount &&
+        next.hitterMetric == m_query.hitterMetric && next.hitterWindow == m_query.hitterWindow &&
+        next.hitterCount == m_query.hitterCount) {
+        return; // already waiting for this one
+    }
+    m_query = std::move(next);
+    m_queryVersion.fetch_add(1);
+}
+
+std::shared_ptr<const ProcessList> SystemMonitor::GetProcesses(const std::string& filter, SearchMode mode,
+                                                              bool tree) const {
+    static const auto empty = std::make_shared<const ProcessList>();
+    auto snapshot = m_procSnapshot.Load();
+    if (!snapshot || snapshot->query.filter != filter || snapshot->query.mode != mode ||
+        snapshot->query.tree != tree) {
+        PostProcessQuery([&](ProcessQuery& q) {
+            q.filter = filter;
+            q.mode = mode;
+            q.tree = tree;
+        });
+    }
+    return snapshot && snapshot->list ? snapshot->list : empty;
+}
+
+std::shared_ptr<const ProcessList> SystemMonitor::GetTopProcesses(TopMetric metric, size_t count) const {
+    static const auto empty = std::make_shared<const ProcessList>();
+    auto snapshot = m_procSnapshot.Load();
+    if (!snapshot || snapshot->query.topMetric != metric || snapshot->query.topCount != count) {
+        PostProcessQuery([&](ProcessQuery& q) {
+            q.topMetric = metric;
+            q.topCount = count;
+        });
+    }
+    return snapshot && snapshot->top ? snapshot->top : empty;
+}
+
+std::shared_ptr<const ProcessDetails> SystemMonitor::GetProcessDetails(const ProcessKey& key, bool withEnviron) const {
+    std::lock_guard<std::mutex> lock(m_detailsMutex);
+    auto cached = m_details.Find(key);
+    if (cached && (cached->hasEnviron || cached->missing || !withEnviron)) return cached;
+    // Queued at most once however many frames ask before it's loaded
+    auto [it, inserted] = m_detailRequests.emplace(key, withEnviron);
+    if (!inserted) it->second = it->second || withEnviron;
+    return cached;
+}
+
+void SystemMonitor::GetHeavyHitters(HitterMetric metric, std::chrono::seconds window, size_t count,
+                                    std::vector<HeavyHitter>& out) const {
+    auto snapshot = m_procSnapshot.Load();
+    if (!snapshot || snapshot->query.hitterMetric != metric || snapshot->query.hitterWindow != window ||
+        snapshot->query.hitterCount != count) {
+        PostProcessQuery([&](ProcessQuery& q) {
+            q.hitterMetric = metric;
+            q.hitterWindow = window;
+            q.hitterCount = count;
+        });
+    }
+    if (snapshot) {
+        out = snapshot->hitters;
+    } else {
+        out.clear();
+    }
+}
+
+std::shared_ptr<const CgroupList> SystemMonitor::GetCgroups() const {
+    static const auto empty = std::make_shared<const CgroupList>();
+    auto list = m_cgroupList.Load();
+    return list ? list : empty;
+}
+
+ProcessInfo SystemMonitor::MakeProcessInfo(uint32_t slot) const {
+    const ProcessTable::Columns& cols = m_processTable.Cols();
+    const StringPool& names = m_processTable.Names();
+    ProcessInfo p;
+    p.pid = cols.key[slot].pid;
+    p.startTime = cols.key[slot].startTime;
+    p.nameId = cols.nameId[slot];
+    p.name = p.nameId == StringPool::EmptyId ? "unknown" : names.CStr(p.nameId);
+    p.state = cols.state[slot];
+    p.threads = static_cast<int>(cols.threads[slot]);
+    p.cpuPercent = cols.cpuPercent[slot];
+    p.rssBytes = cols.rssBytes[slot];
+    p.vsizeBytes = cols.vsizeBytes[slot];
+    p.memSampled = cols.memSampled[slot] != 0;
+    p.pssBytes = cols.pssBytes[slot];
+    p.ussBytes = cols.ussBytes[slot];
+    p.swapBytes = cols.swapBytes[slot];
+    p.hasIo = cols.hasIo[slot] != 0;
+    p.ioReadRate = cols.ioReadRate[slot];
+    p.ioWriteRate = cols.ioWriteRate[slot];
+    p.ioSyscrRate = cols.ioSyscrRate[slot];
+    p.ioSyscwRate = cols.ioSyscwRate[slot];
+    p.ppid = cols.ppid[slot];
+    p.depth = static_cast<int>(cols.depth[slot]);
+    p.descendants = static_cast<int>(cols.descendants[slot]);
+    p.subtreeCpu = cols.subtreeCpu[slot];
+    p.subtreeRss = cols.subtreeRss[slot];
+    return p;
+}
+
+std::shared_ptr<const ProcessDelta> SystemMonitor::GetProcessDelta() const {
+    static const auto empty = std::make_shared<const ProcessDelta>();
+    auto snapshot = m_procSnapshot.Load();
+    return snapshot ? snapshot->delta : empty;
+}
+
+ProcessScanStats SystemMonitor::GetProcessScanStats() const {
+    auto snapshot = m_procSnapshot.Load();
+    return snapshot ? snapshot->scanStats : ProcessScanStats{};
+}
+
+void SystemMonitor::PublishProcesses() {
+    // Process thread: the table and index only change here, so no lock to read them
+    const uint64_t queryVersion = m_queryVersion.load();
+    const bool queryChanged = queryVersion != m_appliedQueryVersion;
+    if (queryChanged) {
+        std::lock_guard<std::mutex> lock(m_queryMutex);
+        m_appliedQuery = m_query;
+        m_appliedQueryVersion = m_queryVersion.load();
+    }
+    const uint64_t dataVersion = m_processTable.DataVersion();
+    const uint64_t indexVersion = m_searchIndex.Version();
+    bool allRowsChanged = false;
+    m_processTable.TakeChangedRows(m_changedRows, allRowsChanged);
+    const uint64_t pinsVersion = m_pinsVersion.load();
+    auto previous = m_procSnapshot.Load();
+    if (previous && !queryChanged && dataVersion == m_publishedDataVersion &&
+        indexVersion == m_publishedIndexVersion && pinsVersion == m_publishedPinsVersion) {
+        return;
+    }
+    const bool dataChanged = !previous || dataVersion != m_publishedDataVersion;
+    m_publishedDataVersion = dataVersion;
+    m_publishedIndexVersion = indexVersion;
+
+    const ProcessQuery& query = m_appliedQuery;
+    auto snapshot = std::make_shared<ProcessSnapshot>();
+    snapshot->version = previous ? previous->version + 1 : 1;
+    snapshot->query = query;
+    snapshot->scanStats = m_scanStats;
+    // A non-empty delta always has a generation of its own, so equal
+    // generations and emptiness mean equal contents
+    if (previous && previous->delta->generation == m_lastDelta.generation &&
+        previous->delta->Empty() == m_lastDelta.Empty()) {
+        snapshot->delta = previous->delta;
+    } else {
+        snapshot->delta = std::make_shared<const ProcessDelta>(m_lastDelta);
+    }
+
+    if (previous && previous->pinned && pinsVersion == m_publishedPinsVersion) {
+        snapshot->pinned = previous->pinned;
+    } else {
+        auto pinned = std::make_shared<PinnedKeys>();
+        pinned->version = pinsVersion;
+        {
+            std::lock_guard<std::mutex> lock(m_pinMutex);
+            for (const PinTarget& p : m_pins) pinned->keys.push_back(p.key);
+        }
+        std::sort(pinned->keys.begin(), pinned->keys.end(), PinnedKeyLess);
+        snapshot->pinned = std::move(pinned);
+        m_publishedPinsVersion = pinsVersion;
+    }
+
+    // Filtered list. The slots on it change only with the matches or the
+    // layout; its rows only where the table says they did.
+    const bool matchesChanged = m_procFilter.Update(m_processTable, m_searchIndex, query.filter, query.mode);
+    const std::shared_ptr<const ProcessList> previousList = previous ? previous->list : nullptr;
+    const bool layoutChanged = !previousList || previous->query.tree != query.tree ||
+                               (query.tree && m_processTable.TreeVersion() != m_publishedTreeVersion);
+    m_publishedTreeVersion = m_processTable.TreeVersion();
+    if (matchesChanged || layoutChanged) {
+        const ProcessTable::Columns& cols = m_processTable.Cols();
+        m_listSlots.clear();
+        if (query.tree) {
+            // Keep the path from every match up to its root so rows have context
+            m_treeRowMask.assign(cols.key.size(), 0);
+            for (uint32_t slot : m_procFilter.Matches()) {
+                for (int32_t a = static_cast<int32_t>(slot); a >= 0 && !m_treeRowMask[a]; a = cols.parent[a]) {
+                    m_treeRowMask[a] = 1;
+                }
+            }
+            for (uint32_t slot : m_processTable.TreeOrder()) {
+                if (m_treeRowMask[slot]) m_listSlots.push_back(slot);
+            }
+        } else {
+            m_listSlots = m_procFilter.Matches();
+        }
+    }
+    // Rows of previousList by slot, minus the ones that changed
+    constexpr uint32_t NoRow = UINT32_MAX;
+    bool rowsChanged = allRowsChanged;
+    for (uint32_t slot : m_changedRows) {
+        if (slot < m_rowBySlot.size() && m_rowBySlot[slot] != NoRow) {
+            m_rowBySlot[slot] = NoRow;
+            rowsChanged = true;
+        }
+    }
+    if (!matchesChanged && !layoutChanged && !rowsChanged) {
+        snapshot->list = previousList;
+    } else {
+        auto list = std::make_shared<ProcessList>();
+        list->version = ++m_procListVersion;
+        list->error = m_procFilter.Error();
+        list->rows.reserve(m_listSlots.size());
+        // Copying an unchanged row beats gathering it from two dozen columns
+        const bool reuse = previousList && !allRowsChanged;
+        for (uint32_t slot : m_listSlots) {
+            const uint32_t row = reuse && slot < m_rowBySlot.size() ? m_rowBySlot[slot] : NoRow;
+            list->rows.push_back(row != NoRow ? previousList->rows[row] : MakeProcessInfo(slot));
+        }
+        m_rowBySlot.assign(m_processTable.SlotCount(), NoRow);
+        for (size_t i = 0; i < m_listSlots.size(); ++i) m_rowBySlot[m_listSlots[i]] = static_cast<uint32_t>(i);
+        snapshot->list = std::move(list);
+    }
+
+    if (query.topCount > 0) {
+        if (!dataChanged && previous && previous->top && previous->query.topMetric == query.topMetric &&
+            previous->query.topCount == query.topCount) {
+            snapshot->top = previous->top;
+        } else {
+            m_processTable.TopSlots(query.topMetric, query.topCount, m_topSlots);
+            auto list = std::make_shared<ProcessList>();
+            list->version = ++m_procListVersion;
+            list->rows.reserve(m_topSlots.size());
+            for (uint32_t slot : m_topSlots) list->rows.push_back(MakeProcessInfo(slot));
+            snapshot->top = std::move(list);
         }
     }
-    return result;
+
+    if (query.hitterCount > 0) {
+        const HeavyHitters& hitters = query.hitterMetric == HitterMetric::Cpu ? m_cpuHitters : m_ioHitters;
+        const uint64_t total =
+            hitters.Top(std::chrono::steady_clock::now(), query.hitterWindow, query.hitterCount, m_hitterScratch);
+        // Weights are clock ticks for CPU and plain bytes for I/O
+        const double unit = query.hitterMetric == HitterMetric::Cpu ? 1.0 / m_clockTicksPerSecond : 1.0;
+        const StringPool& names = m_processTable.Names();
+        for (const auto& e : m_hitterScratch) {
+            HeavyHitter h;
+            h.name = e.key == StringPool::EmptyId ? "unknown" : names.CStr(e.key);
+            h.amount = static_cast<double>(e.weight) * unit;
+            h.error = static_cast<double>(e.error) * unit;
+            h.share =
+                total > 0 ? static_cast<float>(static_cast<double>(e.weight) / static_cast<double>(total)) : 0.0f;
+            snapshot->hitters.push_back(h);
+        }
+    }
+    m_procSnapshot.Store(std::move(snapshot));
+}
+
+void SystemMonitor::SetThreadTarget(int pid) {
+#if defined(__linux__)
+    m_threadSampler.SetTarget(pid);
+#else
+    (void)pid;
+#endif
+}
+
+std::shared_ptr<const ThreadList> SystemMonitor::GetThreads() const {
+#if defined(__linux__)
+    return m_threadSampler.Latest();
+#else
+    static const auto empty = std::make_shared<const ThreadList>();
+    return empty;
+#endif
+}
+
+void SystemMonitor::SetSmapsBudget(std::chrono::microseconds budget) {
+#if defined(__linux__)
+    m_smapsSampler.SetBudget(budget);
+#else
+    (void)budget;
+#endif
+}
+
+void SystemMonitor::PinProcess(const ProcessKey& key) {
+    PinTarget target;
+    {
+        // Only on a click, so the lock is fine here
+        std::lock_guard<std::mutex> lock(m_tableMutex);
+        int slot = m_processTable.FindSlot(key.pid);
+        if (slot < 0 || !(m_processTable.Cols().key[slot] == key)) return;
+        target.key = key;
+        target.name = m_processTable.Names().Get(m_processTable.Cols().nameId[slot]);
+    }
+    std::lock_guard<std::mutex> lock(m_pinMutex);
+    for (const PinTarget& p : m_pins) {
+        if (p.key == target.key) return;
+    }
+    m_pins.push_back(std::move(target));
+    m_pinsDirty.store(true);
+    m_pinsVersion.fetch_add(1);
+}
+
+void SystemMonitor::UnpinProcess(const ProcessKey& key) {
+    std::lock_guard<std::mutex> lock(m_pinMutex);
+    m_pins.erase(std::remove_if(m_pins.begin(), m_pins.end(), [&](const PinTarget& p) { return p.key == key; }),
+                 m_pins.end());
+    m_pinsDirty.store(true);
+    m_pinsVersion.fetch_add(1);
+}
+
+std::shared_ptr<const PinnedKeys> SystemMonitor::GetPinnedKeys() const {
+    static const auto empty = std::make_shared<const PinnedKeys>();
+    auto snapshot = m_procSnapshot.Load();
+    return snapshot && snapshot->pinned ? snapshot->pinned : empty;
+}
+
+bool PinnedKeys::Contains(const ProcessKey& key) const {
+    return std::binary_search(keys.begin(), keys.end(), key, PinnedKeyLess);
+}
+
+void SystemMonitor::AddPinPattern(const std::string& pattern) {
+    std::string lower = LowercasePattern(pattern);
+    if (lower.empty()) return;
+    std::lock_guard<std::mutex> lock(m_pinMutex);
+    if (std::find(m_pinPatterns.begin(), m_pinPatterns.end(), lower) != m_pinPatterns.end()) return;
+    m_pinPatterns.push_back(std::move(lower));
+    m_pinsDirty.store(true);
+}
+
+void SystemMonitor::RemovePinPattern(const std::string& pattern) {
+    const std::string lower = LowercasePattern(pattern);
+    std::lock_guard<std::mutex> lock(m_pinMutex);
+    if (std::erase(m_pinPatterns, lower) > 0) m_pinsDirty.store(true);
+}
+
+std::vector<std::string> SystemMonitor::GetPinPatterns() const {
+    std::lock_guard<std::mutex> lock(m_pinMutex);
+    return m_pinPatterns;
+}
+
+void SystemMonitor::SetPinRate(unsigned hz) {
+#if defined(__linux__)
+    m_pinSampler.SetRate(hz);
+#else
+    (void)hz;
+#endif
+}
+
+unsigned SystemMonitor::GetPinRate() const {
+#if defined(__linux__)
+    return m_pinSampler.Rate();
+#else
+    return 0;
+#endif
+}
+
+void SystemMonitor::GetPinnedSeries(std::vector<PinnedSeries>& out) const {
+#if defined(__linux__)
+    m_pinSampler.Snapshot(out);
+#else
+    out.clear();
+#endif
 }
 
 bool SystemMonitor::TerminateProcess(int pid, std::string& errorMessage) {
@@ -119,6 +603,34 @@ bool SystemMonitor::TerminateProcess(int pid, std::string& errorMessage) {
 #endif
 }
 
+bool SystemMonitor::TerminateProcessTree(int pid, std::string& errorMessage) {
+    std::vector<int> pids;
+    {
+        std::lock_guard<std::mutex> lock(m_tableMutex);
+        int slot = m_processTable.FindSlot(pid);
+        if (slot < 0) {
+            errorMessage = "process not found";
+            return false;
+        }
+        const ProcessTable::Columns& cols = m_processTable.Cols();
+        m_processTable.ForEachInSubtree(static_cast<uint32_t>(slot),
+                                        [&](uint32_t s, uint32_t) { pids.push_back(cols.key[s].pid); });
+    }
+
+    // Parents first, so a build driver can't respawn the workers we just killed
+    size_t failed = 0;
+    std::string firstError;
+    for (int p : pids) {
+        std::string err;
+        if (!TerminateProcess(p, err) && failed++ == 0) firstError = err;
+    }
+    if (failed > 0) {
+        errorMessage = std::to_string(failed) + " of " + std::to_string(pids.size()) + " failed: " + firstError;
+        return false;
+    }
+    return true;
+}
+
 void SystemMonitor::RequestWeatherRefresh() {
     // Signal worker to perform a fetch
     if (!m_weatherLoading.exchange(true)) {
@@ -131,26 +643,72 @@ std::optional<WeatherInfo> SystemMonitor::GetWeather() const {
     return m_weather;
 }
 
-void SystemMonitor::UpdateHardware() {
-    float cpu = SampleCpuUsage(); // 0..100
+void SystemMonitor::UpdateHardware(std::chrono::steady_clock::time_point now, uint64_t periods) {
+    float cpu = SampleCpuUsage(now); // 0..100
     HardwareStats stats;
     stats.cpuLoadPercent = cpu;
+    stats.sampleTime = now;
+    stats.sampleRateHz = m_sampleRateHz.load();
+    m_missedSamples += periods - 1;
+    stats.missedSamples = m_missedSamples;
     SampleRamUsage(stats);
-
-    {
-        std::lock_guard<std::mutex> lock(m_hwMutex);
-        m_hwStats = stats;
-        if (m_cpuHistory.size() >= MaxHistory) {
-            m_cpuHistory.erase(m_cpuHistory.begin());
+#if !defined(__APPLE__)
+    stats.hasCpuTimes = true;
+    std::copy(std::begin(m_cpuTimes), std::end(m_cpuTimes), stats.cpuTimePercent);
+#endif
+#if defined(__linux__)
+    stats.coreCount = static_cast<int>(m_coreUsage.size());
+    stats.contextSwitchRate = m_contextSwitchRate;
+    stats.interruptRate = m_interruptRate;
+    stats.procsRunning = m_procsRunning;
+    stats.procsBlocked = m_procsBlocked;
+    for (size_t i = 0; i < m_coreUsage.size(); ++i) {
+        if (m_coreUsage[i] > stats.busiestCorePercent || stats.busiestCore < 0) {
+            stats.busiestCore = static_cast<int>(i);
+            stats.busiestCorePercent = m_coreUsage[i];
         }
-        m_cpuHistory.push_back(cpu);
     }
+#endif
+
+    // A late tick stands in for the ones it overran, keeping the history evenly spaced
+    const uint64_t historySamples = static_cast<uint64_t>(m_historyLength) * m_historyStride;
+    for (uint64_t i = 0; i < std::min(periods, historySamples); ++i) {
+        PushHistory(cpu);
+    }
+    PublishHardware(stats);
+}
+
+void SystemMonitor::PublishHardware(const HardwareStats& stats) {
+    // No frame shows more than a few hundred updates a second; in between,
+    // samples only go into the histories and appear with the next snapshot
+    if (stats.sampleTime - m_hwPublished < HardwarePublishInterval) return;
+    m_hwPublished = stats.sampleTime;
+    auto snapshot = std::make_shared<HardwareSnapshot>();
+    snapshot->version = ++m_hwVersion;
+    snapshot->stats = stats;
+    snapshot->historyStride = m_historyStride;
+    // Histories gain a point once per stride; until then every snapshot shares the last copy
+    if (!m_publishedCpuHistory || m_publishedCpuHistoryVersion != m_cpuHistoryVersion) {
+        m_publishedCpuHistory = std::make_shared<const std::vector<float>>(m_cpuHistory);
+        m_publishedCpuHistoryVersion = m_cpuHistoryVersion;
+    }
+    if (!m_publishedCoreHistory || m_publishedCoreHistory->Version() != m_coreHistory.Version()) {
+        m_publishedCoreHistory = std::make_shared<const CoreHistory>(m_coreHistory);
+    }
+    if (!m_publishedCpuTimeHistory || m_publishedCpuTimeHistory->Version() != m_cpuTimeHistory.Version()) {
+        m_publishedCpuTimeHistory = std::make_shared<const SeriesHistory>(m_cpuTimeHistory);
+    }
+    snapshot->cpuHistory = m_publishedCpuHistory;
+    snapshot->coreHistory = m_publishedCoreHistory;
+    snapshot->cpuTimeHistory = m_publishedCpuTimeHistory;
+    m_hwSnapshot.Store(std::move(snapshot));
 }
 
 // --- CPU / RAM sampling ---
 
-float SystemMonitor::SampleCpuUsage() {
+float SystemMonitor::SampleCpuUsage(std::chrono::steady_clock::time_point now) {
 #ifdef _WIN32
+    (void)now;
     FILETIME idleTime, kernelTime, userTime;
     if (!GetSystemTimes(&idleTime, &kernelTime, &userTime)) {
         return 0.0f;
@@ -175,10 +733,15 @@ float SystemMonitor::SampleCpuUsage() {
     m_lastKernelTime = kernel;
     m_lastUserTime = user;
 
-    if (total == 0) return 0.0f;
-    float usage = 100.0f * (1.0f - (float)idleDiff / (float)total);
-    return usage;
+    // No scheduler tick since the last sample: keep the previous value
+    if (total == 0) return m_cpuUsage;
+    // Kernel time includes idle time
+    m_cpuTimes[CpuUser] = 100.0f * (float)userDiff / (float)total;
+    m_cpuTimes[CpuSystem] = 100.0f * (float)(kernelDiff - std::min(idleDiff, kernelDiff)) / (float)total;
+    m_cpuUsage = 100.0f * (1.0f - (float)idleDiff / (float)total);
+    return m_cpuUsage;
 #elif defined(__APPLE__)
+    (void)now;
     // macOS: approximate CPU usage using load average vs. CPU count
     double load = 0.0;
     if (getloadavg(&load, 1) != 1) {
@@ -194,31 +757,69 @@ float SystemMonitor::SampleCpuUsage() {
     float usage = static_cast<float>(std::min(load / static_cast<double>(ncpu), 1.0) * 100.0);
     return usage;
 #else
-    // Linux /proc/stat
-    std::ifstream stat("/proc/stat");
-    if (!stat) return 0.0f;
-    std::string cpuLabel;
-    unsigned long long user = 0, nice = 0, system = 0, idle = 0;
-    unsigned long long iowait = 0, irq = 0, softirq = 0, steal = 0;
-    stat >> cpuLabel >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-    if (cpuLabel != "cpu") return 0.0f;
-
-    unsigned long long idleAll = idle + iowait;
-    unsigned long long nonIdle = user + nice + system + irq + softirq + steal;
-    unsigned long long total = idleAll + nonIdle;
-
-    unsigned long long totalDiff = total - m_lastTotalJiffies;
-    unsigned long long idleDiff = idleAll - m_lastIdleJiffies;
-
-    m_lastTotalJiffies = total;
-    m_lastIdleJiffies = idleAll;
-
-    if (totalDiff == 0) return 0.0f;
-    float usage = 100.0f * (float)(totalDiff - idleDiff) / (float)totalDiff;
-    return usage;
+    // Linux /proc/stat through a descriptor kept open across samples
+    if (!m_statReader.Read(m_statScratch)) return m_cpuUsage;
+    const size_t window = m_statWindow.size();
+    TimedStat& newest = m_statWindow[m_statHead];
+    std::swap(newest.stat, m_statScratch); // the ring keeps its buffers, so no allocation
+    newest.time = now;
+    m_statHead = (m_statHead + 1) % window;
+    m_statCount = std::min(m_statCount + 1, window);
+    const SystemStat& cur = newest.stat;
+    m_lastTotalJiffies = cur.total.Total();
+    m_procsRunning = static_cast<int>(cur.procsRunning);
+    m_procsBlocked = static_cast<int>(cur.procsBlocked);
+    m_coreUsage.resize(cur.cores.size(), 0.0f);
+    if (m_statCount < 2) return m_cpuUsage;
+
+    // Oldest sample in the window vs. this one. Counters move in whole clock
+    // ticks; an interval that saw none keeps the previous value instead of
+    // reading as idle.
+    const TimedStat& oldest = m_statWindow[(m_statHead + window - m_statCount) % window];
+    const SystemStat& base = oldest.stat;
+    auto usageOf = [](const CpuTimes& c, const CpuTimes& p, float previous) {
+        unsigned long long totalDiff = c.Total() - p.Total();
+        unsigned long long idleDiff = c.Idle() - p.Idle();
+        return totalDiff == 0 ? previous : 100.0f * (float)(totalDiff - idleDiff) / (float)totalDiff;
+    };
+    for (size_t i = 0; i < cur.cores.size(); ++i) {
+        // Offline cores have no line and report zero
+        if (!cur.coreOnline[i]) {
+            m_coreUsage[i] = 0.0f;
+        } else if (i < base.cores.size() && base.coreOnline[i]) {
+            m_coreUsage[i] = usageOf(cur.cores[i], base.cores[i], m_coreUsage[i]);
+        }
+    }
+    if (cur.total.Total() != base.total.Total()) {
+        m_cpuUsage = usageOf(cur.total, base.total, m_cpuUsage);
+        CpuTimeBreakdown(cur.total, base.total, m_cpuTimes);
+    }
+
+    const double seconds = std::chrono::duration<double>(now - oldest.time).count();
+    if (seconds > 0.0) {
+        m_contextSwitchRate =
+            static_cast<float>(static_cast<double>(cur.contextSwitches - base.contextSwitches) / seconds);
+        m_interruptRate = static_cast<float>(static_cast<double>(cur.interrupts - base.interrupts) / seconds);
+    }
+    return m_cpuUsage;
 #endif
 }
 
+#if defined(__linux__)
+void SystemMonitor::ResetStatWindow(unsigned rateHz) {
+    // Samples at least CpuWindow apart, plus the one that closes the window
+    const double perWindow = rateHz * std::chrono::duration<double>(CpuWindow).count();
+    const size_t window = std::max<size_t>(1, static_cast<size_t>(std::ceil(perWindow))) + 1;
+    // Keep the newest sample, so the first one at the new rate has a baseline
+    if (m_statCount > 0) {
+        std::swap(m_statWindow[(m_statHead + m_statWindow.size() - 1) % m_statWindow.size()], m_statWindow[0]);
+    }
+    m_statWindow.resize(window);
+    m_statCount = std::min<size_t>(m_statCount, 1);
+    m_statHead = m_statCount % window;
+}
+#endif
+
 void SystemMonitor::SampleRamUsage(HardwareStats& stats) const {
 #ifdef _WIN32
     MEMORYSTATUSEX mem{};
@@ -268,52 +869,400 @@ void SystemMonitor::SampleRamUsage(HardwareStats& stats) const {
 
 // --- Process enumeration ---
 
-std::vector<ProcessInfo> SystemMonitor::QueryProcesses() const {
-    std::vector<ProcessInfo> procs;
+void SystemMonitor::UpdateProcesses() {
+    ProcessScanStats scanStats;
+    scanStats.forks = m_scanStats.forks;
+    scanStats.exits = m_scanStats.exits;
+    auto now = std::chrono::steady_clock::now();
+    bool scanDue = now - m_lastFullScan >= ProcScanInterval;
+
+#if defined(__linux__)
+    if (m_procEvents.IsOpen()) {
+        m_procEventBuf.clear();
+        bool complete = m_procEvents.Poll(m_procEventBuf);
+        scanStats.eventDriven = true;
+        if (complete && !scanDue) {
+            ApplyProcessEvents(scanStats);
+            DropExitedDescriptors();
+            m_cgroups.Apply(m_lastDelta);
+            DropExitedDetails();
+            IndexNewProcesses();
+            return;
+        }
+        scanDue = true;
+        // Reconciling: the scan supersedes the events, but keep counting them
+        for (const auto& e : m_procEventBuf) {
+            if (e.type == ProcConnector::EventType::Fork) ++scanStats.forks;
+            if (e.type == ProcConnector::EventType::Exit) ++scanStats.exits;
+        }
+    }
+#endif
+    if (!scanDue) return;
+
+#if defined(__linux__)
+    size_t fdBudget = m_procFdBudget.load();
+    if (fdBudget != SIZE_MAX && fdBudget != m_appliedFdBudget) {
+        m_procScanner.SetFdBudget(fdBudget);
+        m_appliedFdBudget = fdBudget;
+    }
+#endif
+
+    bool scanned = QueryProcesses(m_statRecords);
+    std::chrono::duration<float, std::milli> scanTime = std::chrono::steady_clock::now() - now;
+    if (!scanned) {
+#if defined(__linux__)
+        // A partial list would drop live processes; keep the previous rows and retry next tick
+        std::lock_guard<std::mutex> lock(m_tableMutex);
+        m_scanStats.scanError = m_procScanner.LastError();
+#endif
+        return;
+    }
+    m_lastFullScan = now;
+
+    scanStats.scanMs = scanTime.count();
+    scanStats.processCount = m_statRecords.size();
+#if defined(__linux__)
+    scanStats.syscalls = m_procScanner.LastSyscallCount();
+    scanStats.scanThreads = m_procScanner.WorkerCount();
+    scanStats.uringThreads = m_procScanner.ActiveRingCount();
+    scanStats.cachedFds = m_procScanner.CachedFdCount();
+    scanStats.evictedFds = m_procScanner.EvictedFdCount();
+    scanStats.fdBudget = m_procScanner.FdBudget();
+
+    // Same jiffy clock as the latest hardware sample, so process and system CPU agree
+    double elapsedTicksPerCpu = 0.0;
+    const unsigned long long totalJiffies = m_lastTotalJiffies.load();
+    if (m_jiffiesAtLastScan != 0) {
+        elapsedTicksPerCpu = static_cast<double>(totalJiffies - m_jiffiesAtLastScan) / m_cpuCount;
+    }
+    m_jiffiesAtLastScan = totalJiffies;
+    const double elapsedSeconds = elapsedTicksPerCpu / m_clockTicksPerSecond;
+
+    m_smapsResults.clear();
+    m_smapsSampler.TakeResults(m_smapsResults);
+    scanStats.smapsSamples = m_smapsSampler.LastTickSamples();
+    scanStats.smapsMs = m_smapsSampler.LastTickMs();
+#else
+    double elapsedTicksPerCpu = 0.0;
+    double elapsedSeconds = 0.0;
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(m_tableMutex);
+        m_processTable.BeginScan();
+        for (const auto& rec : m_statRecords) {
+            m_processTable.Observe(rec);
+        }
+        m_processTable.EndScan();
+        // Ticks and bytes since the previous scan, before ComputeRates() folds them in
+        const ProcessTable::Columns& cols = m_processTable.Cols();
+        m_processTable.ForEachSlot([&](uint32_t slot) {
+            m_cpuHitters.Add(now, cols.nameId[slot], cols.cpuTicks[slot] - cols.prevCpuTicks[slot]);
+            m_ioHitters.Add(now, cols.nameId[slot],
+                            (cols.ioReadBytes[slot] - cols.prevIoReadBytes[slot]) +
+                                (cols.ioWriteBytes[slot] - cols.prevIoWriteBytes[slot]));
+        });
+        m_processTable.ComputeRates(elapsedTicksPerCpu, elapsedSeconds);
+#if defined(__linux__)
+        for (const auto& sample : m_smapsResults) {
+            m_processTable.SetMemoryBreakdown(sample.key, sample.pssBytes, sample.ussBytes, sample.swapBytes);
+        }
+#endif
+        m_processTable.UpdateTree();
+        m_processTable.TakeDelta(m_lastDelta);
+        for (const auto& key : m_lastDelta.removed) {
+            m_searchIndex.Remove(key);
+        }
+        scanStats.uniqueNames = m_processTable.Names().Size();
+        scanStats.namePoolBytes = m_processTable.Names().Bytes();
+        scanStats.indexedBytes = m_searchIndex.TextBytes();
+        scanStats.indexedTrigrams = m_searchIndex.TrigramCount();
+        m_scanStats = scanStats;
+    }
+#if defined(__linux__)
+    DropExitedDescriptors();
+
+    // Next round of PSS/USS sampling runs in the background until the next scan
+    m_smapsCandidates.clear();
+    const ProcessTable::Columns& cols = m_processTable.Cols();
+    m_processTable.ForEachSlot([&](uint32_t slot) {
+        m_smapsCandidates.push_back(SmapsSampler::Candidate{cols.key[slot], slot, cols.rssBytes[slot]});
+    });
+    m_smapsSampler.Submit(m_smapsCandidates);
+
+    m_cgroups.Apply(m_lastDelta);
+    m_cgroups.Collect(now);
+    PublishCgroups();
+#endif
+    DropExitedDetails();
+    IndexNewProcesses();
+}
+
+void SystemMonitor::DropExitedDetails() {
+    // m_lastDelta is only written by this thread
+    std::lock_guard<std::mutex> lock(m_detailsMutex);
+    for (const auto& key : m_lastDelta.removed) {
+        m_details.Erase(key);
+    }
+}
+
+void SystemMonitor::LoadRequestedDetails() {
+    {
+        std::lock_guard<std::mutex> lock(m_detailsMutex);
+        if (m_detailRequests.empty()) return;
+        m_detailBatch.assign(m_detailRequests.begin(), m_detailRequests.end());
+        m_detailRequests.clear();
+    }
+    // Read outside the lock so the UI's lookups never wait on /proc
+    for (const auto& [key, withEnviron] : m_detailBatch) {
+        if (!withEnviron) {
+            // Indexed since it was asked for
+            std::lock_guard<std::mutex> lock(m_detailsMutex);
+            if (m_details.Find(key)) continue;
+        }
+        auto details = std::make_shared<ProcessDetails>();
+        if (!LoadProcessDetails(key, withEnviron, *details)) {
+            *details = ProcessDetails{};
+            details->missing = true;
+        }
+        std::lock_guard<std::mutex> lock(m_detailsMutex);
+        m_details.Insert(key, std::move(details));
+    }
+}
+
+void SystemMonitor::IndexNewProcesses() {
+    // Only this thread mutates the table, so it can be read without the lock
+    // while command lines are fetched. Exits were already dropped from the
+    // index together with the table update.
+    const ProcessTable::Columns& cols = m_processTable.Cols();
+    m_indexPending.assign(m_lastDelta.added.begin(), m_lastDelta.added.end());
+    for (const auto& key : m_lastDelta.changed) {
+        int slot = m_processTable.FindSlot(key.pid);
+        if (slot >= 0 && !m_searchIndex.IsIndexed(key, cols.nameId[slot])) {
+            m_indexPending.push_back(key); // exec'd into a new program
+        }
+    }
+    if (m_indexPending.empty()) return;
+
+    // The same read fills the details cache, so the Command column of a new
+    // (or exec'd) process never reads its cmdline a second time
+    m_indexDetails.resize(m_indexPending.size());
+    for (size_t i = 0; i < m_indexPending.size(); ++i) {
+        auto details = std::make_shared<ProcessDetails>();
+        if (!LoadProcessDetails(m_indexPending[i], false, *details)) {
+            // A process that's already gone is still indexed by pid and name
+            *details = ProcessDetails{};
+            details->missing = true;
+        }
+        m_indexDetails[i] = std::move(details);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_detailsMutex);
+        for (size_t i = 0; i < m_indexPending.size(); ++i) m_details.Insert(m_indexPending[i], m_indexDetails[i]);
+    }
+
+    // The index is only read by PublishProcesses() on this thread
+    const StringPool& names = m_processTable.Names();
+    for (size_t i = 0; i < m_indexPending.size(); ++i) {
+        const ProcessKey& key = m_indexPending[i];
+        int slot = m_processTable.FindSlot(key.pid);
+        if (slot < 0 || !(cols.key[slot] == key)) continue;
+        StringPool::Id nameId = cols.nameId[slot];
+        m_searchIndex.Add(static_cast<uint32_t>(slot), key, nameId, cols.pidText[slot].data(), names.Get(nameId),
+                          m_indexDetails[i]->cmdline);
+    }
+    m_indexDetails.clear();
+    m_scanStats.indexedBytes = m_searchIndex.TextBytes();
+    m_scanStats.indexedTrigrams = m_searchIndex.TrigramCount();
+}
+
+#if defined(__linux__)
+void SystemMonitor::ApplyProcessEvents(ProcessScanStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    m_statRecords.clear();
+    m_exitedPids.clear();
+    m_lastExitAt.clear();
+    size_t syscalls = 0;
+    for (size_t i = 0; i < m_procEventBuf.size(); ++i) {
+        if (m_procEventBuf[i].type == ProcConnector::EventType::Exit) m_lastExitAt[m_procEventBuf[i].pid] = i;
+    }
+
+    // Read stat for new/changed processes outside the lock. A fork whose child
+    // is already gone by now still counts; it just never enters the table.
+    for (size_t i = 0; i < m_procEventBuf.size(); ++i) {
+        const auto& e = m_procEventBuf[i];
+        if (e.type == ProcConnector::EventType::Exit) {
+            ++stats.exits;
+            m_exitedPids.push_back(e.pid);
+            continue;
+        }
+        if (e.type == ProcConnector::EventType::Fork) ++stats.forks;
+        // Exits later in the batch: an unreaped zombie would still read fine and come back as a ghost row
+        auto exit = m_lastExitAt.find(e.pid);
+        if (exit != m_lastExitAt.end() && exit->second > i) continue;
+
+        ProcStatRecord rec;
+        if (m_procScanner.ReadOne(e.pid, rec)) {
+            m_statRecords.push_back(rec);
+        } else if (m_procScanner.LastError() != 0) {
+            // Not an exit; the next full scan picks the process up once it can be read
+            stats.scanError = m_procScanner.LastError();
+        }
+        syscalls += m_procScanner.LastSyscallCount();
+    }
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    stats.scanMs = elapsed.count();
+    stats.syscalls = syscalls;
+
+    std::lock_guard<std::mutex> lock(m_tableMutex);
+    if (stats.scanError == 0) stats.scanError = m_scanStats.scanError;
+    // Every record left comes after its pid's last exit, so removing first
+    // only matters for an exit followed by a fork reusing the pid
+    for (int pid : m_exitedPids) {
+        m_processTable.Remove(pid);
+    }
+    for (const auto& rec : m_statRecords) {
+        m_processTable.Observe(rec);
+    }
+    m_processTable.UpdateTree();
+    m_processTable.TakeDelta(m_lastDelta);
+    for (const auto& key : m_lastDelta.removed) {
+        m_searchIndex.Remove(key);
+    }
+    stats.processCount = m_processTable.Size();
+    stats.scanThreads = m_scanStats.scanThreads;
+    stats.uringThreads = m_scanStats.uringThreads;
+    stats.cachedFds = m_procScanner.CachedFdCount();
+    stats.evictedFds = m_procScanner.EvictedFdCount();
+    stats.fdBudget = m_procScanner.FdBudget();
+    stats.uniqueNames = m_processTable.Names().Size();
+    stats.namePoolBytes = m_processTable.Names().Bytes();
+    stats.indexedBytes = m_searchIndex.TextBytes();
+    stats.indexedTrigrams = m_searchIndex.TrigramCount();
+    m_scanStats = stats;
+}
+
+void SystemMonitor::PublishCgroups() {
+    auto list = std::make_shared<CgroupList>();
+    list->available = m_cgroups.IsAvailable();
+    list->fileReads = m_cgroups.LastFileReads();
+    list->collectMs = m_cgroups.LastCollectMs();
+    m_cgroups.Stats(list->groups);
+    std::sort(list->groups.begin(), list->groups.end(),
+              [](const CgroupStats& a, const CgroupStats& b) { return a.cpuPercent > b.cpuPercent; });
+    list->version = ++m_cgroupVersion;
+    m_cgroupList.Store(std::move(list));
+}
+
+void SystemMonitor::DropExitedDescriptors() {
+    // Only the writer thread mutates the table and the delta, so no lock is needed.
+    // A reused pid already got a fresh descriptor from the scanner; keep that one.
+    for (const auto& key : m_lastDelta.removed) {
+        if (m_processTable.FindSlot(key.pid) < 0) {
+            m_procScanner.Forget(key.pid);
+        }
+    }
+}
+
+void SystemMonitor::ResolvePins() {
+    // Patterns can only pick up new processes when the table changed
+    const bool dirty = m_pinsDirty.exchange(false);
+    const uint64_t generation = m_processTable.Generation();
+    if (!dirty && generation == m_pinGeneration) return;
+    m_pinGeneration = generation;
+
+    std::vector<std::string> patterns;
+    {
+        std::lock_guard<std::mutex> lock(m_pinMutex);
+        m_pinTargets = m_pins;
+        patterns = m_pinPatterns;
+    }
+    if (dirty) m_pinNameMatch.clear(); // patterns may have changed
+
+    // Only this thread mutates the table, so it can be read without the lock
+    if (!patterns.empty()) {
+        const ProcessTable::Columns& cols = m_processTable.Cols();
+        const StringPool& names = m_processTable.Names();
+        const size_t explicitPins = m_pinTargets.size();
+        m_pinNameMatch.resize(names.Size(), -2);
+        m_processTable.ForEachSlot([&](uint32_t slot) {
+            if (m_pinTargets.size() - explicitPins >= MaxPatternPins) return;
+            // Names repeat (many workers, one binary): match each name once
+            int16_t& match = m_pinNameMatch[cols.nameId[slot]];
+            if (match == -2) {
+                match = -1;
+                std::string_view name = names.Get(cols.nameId[slot]);
+                for (size_t i = 0; i < patterns.size(); ++i) {
+                    if (FindIgnoreCase(name, patterns[i]) != std::string_view::npos) {
+                        match = static_cast<int16_t>(i);
+                        break;
+                    }
+                }
+            }
+            if (match < 0) return;
+            for (size_t i = 0; i < explicitPins; ++i) {
+                if (m_pinTargets[i].key == cols.key[slot]) return;
+            }
+            m_pinTargets.push_back(
+                PinTarget{cols.key[slot], std::string(names.Get(cols.nameId[slot])), patterns[match]});
+        });
+    }
+    m_pinSampler.SetTargets(m_pinTargets);
+}
+#endif
+
+bool SystemMonitor::QueryProcesses(std::vector<ProcStatRecord>& out) {
+    out.clear();
 #ifdef _WIN32
     HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (snap == INVALID_HANDLE_VALUE) return procs;
+    if (snap == INVALID_HANDLE_VALUE) return false;
 
     PROCESSENTRY32 entry{};
     entry.dwSize = sizeof(entry);
     if (Process32First(snap, &entry)) {
         do {
-            ProcessInfo p;
-            p.pid = static_cast<int>(entry.th32ProcessID);
-            p.name = entry.szExeFile;
-            procs.push_back(std::move(p));
+            ProcStatRecord rec;
+            rec.pid = static_cast<int>(entry.th32ProcessID);
+            rec.ppid = static_cast<int>(entry.th32ParentProcessID);
+            FillRecordName(rec, entry.szExeFile, std::strlen(entry.szExeFile));
+            out.push_back(rec);
         } while (Process32Next(snap, &entry));
     }
     CloseHandle(snap);
+    return true;
+#elif defined(__linux__)
+    // Linux: native /proc walk, no fork/exec per tick
+    return m_procScanner.Scan(out);
 #else
-    // POSIX (macOS/Linux): use 'ps' to enumerate processes
-    FILE* pipe = popen("ps -axo pid=,comm=", "r");
+    // macOS: use 'ps' to enumerate processes
+    FILE* pipe = popen("ps -axo pid=,ppid=,comm=", "r");
     if (!pipe) {
-        return procs;
+        return false;
     }
 
     char buffer[512];
     while (fgets(buffer, sizeof(buffer), pipe)) {
         std::istringstream iss(buffer);
         int pid = 0;
+        int ppid = 0;
         std::string name;
-        if (!(iss >> pid))
+        if (!(iss >> pid >> ppid))
             continue;
         std::getline(iss, name);
         // Trim leading spaces
         name.erase(name.begin(),
                    std::find_if(name.begin(), name.end(),
                                 [](unsigned char c) { return !std::isspace(c); }));
-        if (name.empty()) name = "unknown";
 
-        ProcessInfo p;
-        p.pid = pid;
-        p.name = name;
-        procs.push_back(std::move(p));
+        ProcStatRecord rec;
+        rec.pid = pid;
+        rec.ppid = ppid;
+        FillRecordName(rec, name.data(), name.size());
+        out.push_back(rec);
     }
     pclose(pipe);
+    return true;
 #endif
-    return procs;
 }
 
 // --- Weather ---
@@ -7,16 +7,160 @@
 #include <thread>
 #include <optional>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "ProcessFilter.h"
+#include "CgroupCollector.h"
+#include "CoreHistory.h"
+#include "HeavyHitters.h"
+#include "IntervalTimer.h"
+#include "PinSampler.h"
+#include "ProcessDetails.h"
+#include "ProcessTable.h"
+#include "SearchIndex.h"
+#include "SeriesHistory.h"
+#include "SmapsSampler.h"
+#include "Snapshot.h"
+#include "SystemStat.h"
+#include "ThreadSampler.h"
+
+#if defined(__linux__)
+#include "ProcConnector.h"
+#include "ProcScanner.h"
+#endif
 
 struct ProcessInfo {
-    int pid;
-    std::string name;
+    int pid = 0;
+    unsigned long long startTime = 0;
+    StringPool::Id nameId = StringPool::EmptyId;
+    const char* name = "";   // interned; valid for the monitor's lifetime
+    char state = '?';
+    int threads = 0;
+    float cpuPercent = 0.0f; // 100 = one fully busy core
+    unsigned long long rssBytes = 0;
+    unsigned long long vsizeBytes = 0;
+
+    // From smaps_rollup, sampled in the background (Linux); zero until memSampled
+    bool memSampled = false;
+    unsigned long long pssBytes = 0;
+    unsigned long long ussBytes = 0;
+    unsigned long long swapBytes = 0;
+
+    // From /proc/<pid>/io (Linux); hasIo is false where it isn't readable
+    bool hasIo = false;
+    float ioReadRate = 0.0f;  // bytes/s that reached the storage layer
+    float ioWriteRate = 0.0f; // bytes/s
+    float ioSyscrRate = 0.0f; // read syscalls/s
+    float ioSyscwRate = 0.0f; // write syscalls/s
+
+    // Process tree
+    int ppid = 0;
+    int depth = 0;            // 0 for roots
+    int descendants = 0;
+    float subtreeCpu = 0.0f;  // this process and everything below it
+    unsigned long long subtreeRss = 0;
+};
+
+// Immutable filtered view handed to the UI. The monitor returns the same
+// object until the query or the underlying rows change, so callers can
+// hold on to it and compare versions instead of rebuilding per frame.
+struct ProcessList {
+    uint64_t version = 0;
+    std::vector<ProcessInfo> rows; // best match first in fuzzy mode, preorder in tree mode
+    std::string error;             // invalid regex, otherwise empty
+};
+
+// Active cgroups as of the last full scan (see CgroupCollector)
+struct CgroupList {
+    uint64_t version = 0;
+    bool available = false; // a cgroup v2 hierarchy was found (Linux)
+    size_t fileReads = 0;   // accounting files read by the last collection
+    float collectMs = 0.0f;
+    std::vector<CgroupStats> groups; // busiest CPU first
+};
+
+// Explicitly pinned processes, as published with the process snapshot
+struct PinnedKeys {
+    uint64_t version = 0;
+    std::vector<ProcessKey> keys; // by pid, then start time
+
+    bool Contains(const ProcessKey& key) const;
+};
+
+// What GetHeavyHitters() ranks by
+enum class HitterMetric { Cpu, Io };
+
+// One process name's share of CPU time or storage I/O over a window (see HeavyHitters)
+struct HeavyHitter {
+    const char* name = "";
+    double amount = 0.0; // CPU seconds, or bytes read + written
+    double error = 0.0;  // amount is accurate to within this
+    float share = 0.0f;  // of the window's total across all processes, 0..1
 };
 
 struct HardwareStats {
     float cpuLoadPercent = 0.0f;
+    int coreCount = 0;            // cores with per-core data (Linux), else 0
+    int busiestCore = -1;
+    float busiestCorePercent = 0.0f;
+    // Where CPU time went, indexed by CpuCategory; Linux has every category,
+    // Windows only user and system, macOS none
+    bool hasCpuTimes = false;
+    float cpuTimePercent[CpuCategoryCount] = {};
+    // Scheduler activity from /proc/stat (Linux), per second
+    float contextSwitchRate = 0.0f;
+    float interruptRate = 0.0f;
+    int procsRunning = 0;         // runnable right now, including the running ones
+    int procsBlocked = 0;         // waiting on I/O
     float ramUsedGB = 0.0f;
     float ramTotalGB = 0.0f;
+
+    std::chrono::steady_clock::time_point sampleTime{}; // when this sample was taken
+    unsigned sampleRateHz = 0;
+    uint64_t missedSamples = 0; // timer periods the sampler overran, filled by repeating a sample
+};
+
+struct ProcessScanStats {
+    float scanMs = 0.0f;     // wall time of the last process enumeration
+    size_t processCount = 0;
+    size_t syscalls = 0;     // Linux /proc backend only
+    size_t scanThreads = 0;  // threads the Linux /proc backend scans on
+    size_t uringThreads = 0; // of those, the ones still reading through io_uring
+    size_t cachedFds = 0;    // stat descriptors kept open between scans
+    size_t evictedFds = 0;   // closed to make room for hotter pids, cumulative
+    size_t fdBudget = 0;
+    size_t uniqueNames = 0;  // distinct interned process names
+    size_t namePoolBytes = 0;
+    size_t indexedBytes = 0; // names and command lines held by the search index
+    size_t indexedTrigrams = 0;
+    size_t smapsSamples = 0; // smaps_rollup files read in the last background tick
+    float smapsMs = 0.0f;
+    // errno of the last failed full scan or event read (Linux), e.g. EMFILE;
+    // 0 once a full scan succeeds. The table keeps its previous rows meanwhile.
+    int scanError = 0;
+
+    // Linux proc connector; counters are cumulative since start
+    bool eventDriven = false;
+    unsigned long long forks = 0;
+    unsigned long long exits = 0;
+};
+
+// Everything the Hardware tab draws, as of one sample. Immutable once
+// published; version increases with every new snapshot.
+struct HardwareSnapshot {
+    uint64_t version = 0;
+    HardwareStats stats;
+    // Each point averages historyStride consecutive samples, so the histories
+    // span the same time at any sample rate without growing past a screenful.
+    // A history only gains a point once per stride, so consecutive snapshots
+    // share it until then. Never null.
+    unsigned historyStride = 1;
+    std::shared_ptr<const std::vector<float>> cpuHistory; // one value per point, oldest first
+    std::shared_ptr<const CoreHistory> coreHistory;       // per core (Linux), same points
+    std::shared_ptr<const SeriesHistory> cpuTimeHistory;  // one series per CpuCategory, same points
 };
 
 struct WeatherInfo {
@@ -31,17 +175,110 @@ public:
     SystemMonitor();
     ~SystemMonitor();
 
-    // Called each frame (or at some fixed interval)
+    // One hardware sample and one process update, for callers that drive
+    // the monitor themselves. Not to be mixed with StartSampling().
     void Update();
 
-    // Accessors (thread-safe where needed)
-    HardwareStats GetHardwareStats() const;
-    const std::vector<float>& GetCpuHistory() const { return m_cpuHistory; }
+    // Moves sampling onto background threads: hardware at the sample rate,
+    // processes at ProcPollRateHz (kernel events; full scans stay at
+    // ProcScanInterval). Accessors never wait on /proc I/O after this.
+    void StartSampling();
+
+    // Hardware sample rate, clamped to 1..1000 Hz. Taken up at the next tick;
+    // the CPU histories restart then, so they are always evenly spaced.
+    // Whatever the rate, CPU usage is averaged over at least CpuWindow: the
+    // kernel only counts CPU time in clock ticks (usually 10 ms).
+    void SetSampleRate(unsigned hz);
+    unsigned GetSampleRate() const { return m_sampleRateHz.load(); }
+
+    static constexpr unsigned DefaultSampleRateHz = 20;
+    static constexpr unsigned MaxSampleRateHz = 1000;
+    static constexpr unsigned ProcPollRateHz = 50;
+    static constexpr std::chrono::milliseconds CpuWindow{100};
+    static constexpr std::chrono::seconds HistorySpan{10};
+    static constexpr size_t MaxHistoryPoints = 1000;
 
-    std::vector<ProcessInfo> GetProcesses(const std::string& filter) const;
+    // Accessors. Per-frame ones read snapshots the sampling threads publish
+    // and never block on them; an unchanged result is the same object again.
+
+    // Latest hardware sample with its histories. Published at most every
+    // HardwarePublishInterval, so fast sample rates don't copy the histories
+    // on every tick.
+    std::shared_ptr<const HardwareSnapshot> GetHardware() const;
+    HardwareStats GetHardwareStats() const { return GetHardware()->stats; }
+
+    // Case-insensitive search over pid, name and command line (see SearchIndex).
+    // In tree mode matches come with their ancestors, parents before children.
+    //
+    // The process queries below are answered by the process thread for the
+    // most recent arguments, which suits one search box and one table each:
+    // a changed query returns the previous result until the next poll (or
+    // Update()) has published the new one.
+    std::shared_ptr<const ProcessList> GetProcesses(const std::string& filter,
+                                                    SearchMode mode = SearchMode::Substring,
+                                                    bool tree = false) const;
+    ProcessScanStats GetProcessScanStats() const;
+
+    // The count heaviest processes by metric, heaviest first
+    std::shared_ptr<const ProcessList> GetTopProcesses(TopMetric metric, size_t count) const;
+
+    // Full command line, executable and (on request) environment of one
+    // process, cached for its lifetime in a bounded LRU. Never reads /proc on
+    // the caller's thread: a miss queues the load for the process thread and
+    // returns null (or the entry without environ) until it's done, usually a
+    // poll interval later. Meant for the rows on screen; see
+    // ProcessDetails::missing for processes that couldn't be read.
+    std::shared_ptr<const ProcessDetails> GetProcessDetails(const ProcessKey& key, bool withEnviron = false) const;
+
+    // Heaviest CPU or I/O consumers over the trailing window (up to an hour),
+    // grouped by process name so short-lived and periodic jobs add up across pids
+    void GetHeavyHitters(HitterMetric metric, std::chrono::seconds window, size_t count,
+                         std::vector<HeavyHitter>& out) const;
+
+    // Per-cgroup CPU, memory and I/O, republished with every full scan
+    std::shared_ptr<const CgroupList> GetCgroups() const;
+
+    // Changes applied by the most recent process scan. Consumers that see a
+    // gap in generation numbers should resync with GetProcesses(). Shared
+    // with the process snapshot; never null.
+    std::shared_ptr<const ProcessDelta> GetProcessDelta() const;
+
+    // Upper bound on /proc/<pid>/stat descriptors kept open between scans
+    // (Linux). Clamped to the scanner's share of the descriptor pool (see
+    // FdShare); 0 disables the cache.
+    void SetProcFdBudget(size_t budget) { m_procFdBudget.store(budget); }
+
+    // Time the background PSS/USS sampler may spend per scan (Linux); 0 pauses it
+    void SetSmapsBudget(std::chrono::microseconds budget);
+
+    // Per-thread view of one process, sampled every 250 ms on its own thread
+    // while a target is set (Linux). 0 stops sampling.
+    void SetThreadTarget(int pid);
+    std::shared_ptr<const ThreadList> GetThreads() const;
+
+    // Pinned processes are sampled at up to 100 Hz on their own timer, apart
+    // from the 1 Hz scan (Linux). A pinned process stays until unpinned, even
+    // after it exits; a pattern pins every live process whose name contains
+    // it, case-insensitively. Pins are by identity, so a reused pid isn't
+    // pinned along with it.
+    void PinProcess(const ProcessKey& key);
+    void UnpinProcess(const ProcessKey& key);
+    // The explicit pins as of the latest process snapshot; they show up
+    // there within one poll of a change. Lock-free, for per-row checks.
+    std::shared_ptr<const PinnedKeys> GetPinnedKeys() const;
+    bool IsPinned(const ProcessKey& key) const { return GetPinnedKeys()->Contains(key); }
+    // Name patterns, matched and removed case-insensitively
+    void AddPinPattern(const std::string& pattern);
+    void RemovePinPattern(const std::string& pattern);
+    std::vector<std::string> GetPinPatterns() const;
+    void SetPinRate(unsigned hz);
+    unsigned GetPinRate() const;
+    void GetPinnedSeries(std::vector<PinnedSeries>& out) const;
 
     // Returns true on success, false on error
     bool TerminateProcess(int pid, std::string& errorMessage);
+    // Terminates pid and all its descendants, parents first
+    bool TerminateProcessTree(int pid, std::string& errorMessage);
 
     // Weather: trigger async refresh
     void RequestWeatherRefresh();
@@ -49,26 +286,63 @@ public:
     std::optional<WeatherInfo> GetWeather() const;
 
 private:
-    // Hardware
-    void UpdateHardware();
+    // Hardware; periods > 1 after the sampler overran its timer
+    void UpdateHardware(std::chrono::steady_clock::time_point now, uint64_t periods = 1);
+    void UpdateProcesses();
+    void HardwareLoop();
+    void ProcessLoop();
+    void ResetHistory(unsigned rateHz);
+    void PushHistory(float cpu);
 
     // Processes (platform-specific)
-    std::vector<ProcessInfo> QueryProcesses() const;
+    bool QueryProcesses(std::vector<ProcStatRecord>& out);
+    void IndexNewProcesses();
+    ProcessInfo MakeProcessInfo(uint32_t slot) const; // process thread only
+    void PublishHardware(const HardwareStats& stats);
+    void PublishProcesses();
+    void DropExitedDetails();
+    void LoadRequestedDetails();
 
     // Weather
     void WeatherWorker();
     void FetchWeatherBlocking();
 
     // Helpers
-    float SampleCpuUsage();
+    float SampleCpuUsage(std::chrono::steady_clock::time_point now);
     void SampleRamUsage(HardwareStats& stats) const;
 
 private:
-    // Hardware data
-    mutable std::mutex m_hwMutex;
-    HardwareStats m_hwStats{};
-    std::vector<float> m_cpuHistory; // 0..1 or 0..100 depending on how we interpret
-    static constexpr size_t MaxHistory = 256;
+    // Hardware data, owned by the hardware thread and published as snapshots
+    Snapshot<HardwareSnapshot> m_hwSnapshot;
+    uint64_t m_hwVersion = 0;
+    std::chrono::steady_clock::time_point m_hwPublished{};
+    static constexpr std::chrono::milliseconds HardwarePublishInterval{4};
+    std::vector<float> m_cpuHistory; // 0..100
+    uint64_t m_cpuHistoryVersion = 0; // bumped with every change, like CoreHistory::Version()
+    size_t m_historyLength = 0;      // points covering HistorySpan at the current rate
+    unsigned m_historyStride = 1;    // samples averaged into one point
+    CoreHistory m_coreHistory; // same length as m_cpuHistory
+    SeriesHistory m_cpuTimeHistory; // one series per CpuCategory
+    // Copies in the last snapshot, reused while the histories' versions hold
+    std::shared_ptr<const std::vector<float>> m_publishedCpuHistory;
+    uint64_t m_publishedCpuHistoryVersion = 0;
+    std::shared_ptr<const CoreHistory> m_publishedCoreHistory;
+    std::shared_ptr<const SeriesHistory> m_publishedCpuTimeHistory;
+    // Sums of the samples since the last point
+    unsigned m_strideSamples = 0;
+    float m_strideCpu = 0.0f;
+    float m_strideCpuTimes[CpuCategoryCount] = {};
+    std::vector<float> m_strideCores;
+    float m_cpuUsage = 0.0f;                 // last SampleCpuUsage() result
+    float m_cpuTimes[CpuCategoryCount] = {}; // last SampleCpuUsage() breakdown
+    uint64_t m_missedSamples = 0;
+
+    // Sampling threads, started by StartSampling()
+    std::atomic<unsigned> m_sampleRateHz{DefaultSampleRateHz};
+    IntervalTimer m_hwTimer;
+    IntervalTimer m_procTimer;
+    std::thread m_hwThread;
+    std::thread m_procThread;
 
     // CPU sampling state (platform-specific)
 #ifdef _WIN32
@@ -76,8 +350,26 @@ private:
     unsigned long long m_lastKernelTime = 0;
     unsigned long long m_lastUserTime = 0;
 #else
-    unsigned long long m_lastTotalJiffies = 0;
-    unsigned long long m_lastIdleJiffies = 0;
+    std::atomic<unsigned long long> m_lastTotalJiffies{0}; // also read by the process thread
+    std::vector<float> m_coreUsage; // per "cpuN" line, indexed by N
+#if defined(__linux__)
+    // Ring of the /proc/stat samples spanning CpuWindow; usage and rates are
+    // taken between its oldest and newest entries
+    struct TimedStat {
+        SystemStat stat;
+        std::chrono::steady_clock::time_point time{};
+    };
+    void ResetStatWindow(unsigned rateHz);
+    SystemStatReader m_statReader;
+    std::vector<TimedStat> m_statWindow;
+    size_t m_statHead = 0; // next write position
+    size_t m_statCount = 0;
+    SystemStat m_statScratch; // read target, swapped into the ring on success
+    float m_contextSwitchRate = 0.0f;
+    float m_interruptRate = 0.0f;
+    int m_procsRunning = 0;
+    int m_procsBlocked = 0;
+#endif
 #endif
 
     // Weather data
@@ -87,7 +379,116 @@ private:
     std::thread m_weatherThread;
     std::atomic<bool> m_weatherThreadStop{false};
 
-    // Cache of processes (updated in Update())
-    mutable std::mutex m_procMutex;
-    std::vector<ProcessInfo> m_processesCache;
+    // What the UI last asked the process thread for
+    struct ProcessQuery {
+        std::string filter;
+        SearchMode mode = SearchMode::Substring;
+        bool tree = false;
+        TopMetric topMetric = TopMetric::Cpu;
+        size_t topCount = 0; // 0: nobody asked
+        HitterMetric hitterMetric = HitterMetric::Cpu;
+        std::chrono::seconds hitterWindow{0};
+        size_t hitterCount = 0;
+    };
+
+    // Process thread output, replaced whole whenever the table, the search
+    // index or the query changed
+    struct ProcessSnapshot {
+        uint64_t version = 0;
+        ProcessQuery query;
+        std::shared_ptr<const ProcessList> list; // for query.filter/mode/tree
+        std::shared_ptr<const ProcessList> top;
+        std::vector<HeavyHitter> hitters;
+        ProcessScanStats scanStats;
+        std::shared_ptr<const ProcessDelta> delta;
+        std::shared_ptr<const PinnedKeys> pinned;
+    };
+
+    template <typename Fn>
+    void PostProcessQuery(Fn&& edit) const;
+
+    Snapshot<ProcessSnapshot> m_procSnapshot;
+    mutable std::mutex m_queryMutex; // only ever held to copy a ProcessQuery
+    mutable ProcessQuery m_query;
+    mutable std::atomic<uint64_t> m_queryVersion{0};
+
+    // Process table, owned by the process thread. m_tableMutex is held while
+    // it changes, for the few calls from other threads that look a pid up
+    // (pinning, terminating a tree); per-frame accessors never take it.
+    mutable std::mutex m_tableMutex;
+    ProcessTable m_processTable;
+    ProcessDelta m_lastDelta;
+    SearchIndex m_searchIndex;
+    ProcessFilter m_procFilter;
+    ProcessQuery m_appliedQuery;
+    uint64_t m_appliedQueryVersion = 0;
+    uint64_t m_publishedDataVersion = 0;
+    uint64_t m_publishedIndexVersion = 0;
+    uint64_t m_publishedTreeVersion = 0;
+    uint64_t m_procListVersion = 0;
+    std::vector<uint8_t> m_treeRowMask; // scratch for tree-mode filtering
+    std::vector<uint32_t> m_listSlots;  // slots of the published list's rows, in order
+    std::vector<uint32_t> m_rowBySlot;  // inverse of m_listSlots, UINT32_MAX where not listed
+    std::vector<uint32_t> m_changedRows;
+    std::vector<uint32_t> m_topSlots;
+    HeavyHitters m_cpuHitters; // CPU ticks per scan, keyed by name id
+    HeavyHitters m_ioHitters;  // bytes read + written per scan, keyed by name id
+    std::vector<HeavyHitters::Entry> m_hitterScratch;
+    double m_clockTicksPerSecond = 100.0;
+    std::vector<ProcessKey> m_indexPending; // added or exec'd, awaiting a command line
+    std::vector<std::shared_ptr<const ProcessDetails>> m_indexDetails;
+    ProcessScanStats m_scanStats{};
+    std::vector<ProcStatRecord> m_statRecords; // scan output, reused between ticks
+
+    // Lazily loaded command lines etc.; never locked together with m_tableMutex
+    mutable std::mutex m_detailsMutex;
+    mutable ProcessDetailsCache m_details;
+    // Misses waiting for the process thread; the value is whether environ was asked for
+    mutable std::unordered_map<ProcessKey, bool, ProcessKeyHash> m_detailRequests;
+    std::vector<std::pair<ProcessKey, bool>> m_detailBatch; // process thread only
+
+    // Published by the process thread after each full scan
+    Snapshot<CgroupList> m_cgroupList;
+    uint64_t m_cgroupVersion = 0;
+
+    // Pins (m_pinMutex); resolved against the table in ResolvePins()
+    mutable std::mutex m_pinMutex;
+    std::vector<PinTarget> m_pins;          // pinned by pid
+    std::vector<std::string> m_pinPatterns; // lowercase
+    std::atomic<bool> m_pinsDirty{false};
+    std::atomic<uint64_t> m_pinsVersion{0}; // bumped with m_pins
+    uint64_t m_publishedPinsVersion = 0;
+
+    std::chrono::steady_clock::time_point m_lastFullScan{};
+    // Stat is re-read at this cadence; per-process CPU% needs intervals well
+    // above the 10 ms clock tick to mean anything.
+    static constexpr std::chrono::seconds ProcScanInterval{1};
+
+#if defined(__linux__)
+    ProcScanner m_procScanner;
+
+    // With the proc connector live, membership follows kernel events between
+    // the periodic scans (and an early scan follows if the kernel drops events).
+    ProcConnector m_procEvents;
+    ThreadSampler m_threadSampler;
+    PinSampler m_pinSampler;
+    SmapsSampler m_smapsSampler;
+    CgroupCollector m_cgroups;
+    std::vector<SmapsSampler::Candidate> m_smapsCandidates;
+    std::vector<SmapsSample> m_smapsResults;
+    uint64_t m_pinGeneration = 0;
+    std::vector<int16_t> m_pinNameMatch; // per name id: pattern index, -1 none, -2 unknown
+    std::vector<PinTarget> m_pinTargets;
+    std::vector<ProcConnector::Event> m_procEventBuf;
+    std::vector<int> m_exitedPids;
+    std::unordered_map<int, size_t> m_lastExitAt; // ApplyProcessEvents() scratch: pid -> event index
+    std::atomic<size_t> m_procFdBudget{SIZE_MAX}; // SIZE_MAX: scanner default
+    size_t m_appliedFdBudget = SIZE_MAX;
+    unsigned long long m_jiffiesAtLastScan = 0;
+    unsigned int m_cpuCount = 1;
+    void ApplyProcessEvents(ProcessScanStats& stats);
+    void DropExitedDescriptors();
+    void ResolvePins();
+    void PublishCgroups();
+#endif
 };
\ No newline at end of file
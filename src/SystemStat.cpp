@@ -0,0 +1,119 @@
+#include "SystemStat.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+uint64_t ParseU64(const char*& p, const char* end) {
+    while (p < end && *p == ' ') ++p;
+    uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    return v;
+}
+
+bool StartsWith(const char* p, const char* end, const char* prefix, size_t n) {
+    return static_cast<size_t>(end - p) >= n && std::memcmp(p, prefix, n) == 0;
+}
+
+void ParseCpuTimes(const char*& p, const char* end, CpuTimes& t) {
+    t.user = ParseU64(p, end);
+    t.nice = ParseU64(p, end);
+    t.system = ParseU64(p, end);
+    t.idle = ParseU64(p, end);
+    t.iowait = ParseU64(p, end);
+    t.irq = ParseU64(p, end);
+    t.softirq = ParseU64(p, end);
+    t.steal = ParseU64(p, end);
+}
+} // namespace
+
+const char* CpuCategoryName(int category) {
+    static const char* const Names[CpuCategoryCount] = {"user", "nice", "system", "iowait", "irq", "softirq",
+                                                         "steal"};
+    return category >= 0 && category < CpuCategoryCount ? Names[category] : "";
+}
+
+void CpuTimeBreakdown(const CpuTimes& cur, const CpuTimes& prev, float (&out)[CpuCategoryCount]) {
+    // Counters can step back when a core goes offline; clamp instead of wrapping
+    auto delta = [](uint64_t c, uint64_t p) { return c >= p ? c - p : 0; };
+    const uint64_t parts[CpuCategoryCount] = {
+        delta(cur.user, prev.user),     delta(cur.nice, prev.nice), delta(cur.system, prev.system),
+        delta(cur.iowait, prev.iowait), delta(cur.irq, prev.irq),   delta(cur.softirq, prev.softirq),
+        delta(cur.steal, prev.steal),
+    };
+    uint64_t total = delta(cur.idle, prev.idle);
+    for (uint64_t part : parts) total += part;
+    for (int c = 0; c < CpuCategoryCount; ++c) {
+        out[c] = total == 0 ? 0.0f : 100.0f * static_cast<float>(parts[c]) / static_cast<float>(total);
+    }
+}
+
+bool ParseSystemStat(const char* data, size_t len, SystemStat& out) {
+    const char* end = data + len;
+    bool found = false;
+    std::fill(out.coreOnline.begin(), out.coreOnline.end(), 0);
+    for (const char* p = data; p < end;) {
+        if (StartsWith(p, end, "cpu", 3)) {
+            p += 3;
+            if (p < end && *p == ' ') {
+                ParseCpuTimes(p, end, out.total);
+                found = true;
+            } else {
+                const size_t core = static_cast<size_t>(ParseU64(p, end));
+                if (core >= out.cores.size()) out.cores.resize(core + 1);
+                if (core >= out.coreOnline.size()) out.coreOnline.resize(core + 1, 0);
+                ParseCpuTimes(p, end, out.cores[core]);
+                out.coreOnline[core] = 1;
+            }
+        } else if (StartsWith(p, end, "intr ", 5)) {
+            // Only the total; the per-source counts that follow are most of the file
+            p += 5;
+            out.interrupts = ParseU64(p, end);
+        } else if (StartsWith(p, end, "ctxt ", 5)) {
+            p += 5;
+            out.contextSwitches = ParseU64(p, end);
+        } else if (StartsWith(p, end, "procs_running ", 14)) {
+            p += 14;
+            out.procsRunning = static_cast<uint32_t>(ParseU64(p, end));
+        } else if (StartsWith(p, end, "procs_blocked ", 14)) {
+            p += 14;
+            out.procsBlocked = static_cast<uint32_t>(ParseU64(p, end));
+        }
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!eol) break;
+        p = eol + 1;
+    }
+    return found;
+}
+
+#if defined(__linux__)
+SystemStatReader::SystemStatReader(const char* path) : m_buffer(16 * 1024) {
+    m_fd = open(path, O_RDONLY | O_CLOEXEC);
+}
+
+SystemStatReader::~SystemStatReader() {
+    if (m_fd >= 0) close(m_fd);
+}
+
+bool SystemStatReader::Read(SystemStat& out) {
+    if (m_fd < 0) return false;
+    for (;;) {
+        ssize_t n = pread(m_fd, m_buffer.data(), m_buffer.size(), 0);
+        if (n < 0) return false;
+        // A full buffer may have cut the file short; grow once and read it again
+        if (static_cast<size_t>(n) == m_buffer.size()) {
+            m_buffer.resize(m_buffer.size() * 2);
+            continue;
+        }
+        return ParseSystemStat(m_buffer.data(), static_cast<size_t>(n), out);
+    }
+}
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Cumulative time of one "cpu" line of /proc/stat, in clock ticks. Guest time
+// is already included in user and nice, so it isn't kept separately.
+struct CpuTimes {
+    uint64_t user = 0;
+    uint64_t nice = 0;
+    uint64_t system = 0;
+    uint64_t idle = 0;
+    uint64_t iowait = 0;
+    uint64_t irq = 0;
+    uint64_t softirq = 0;
+    uint64_t steal = 0;
+
+    uint64_t Idle() const { return idle + iowait; }
+    uint64_t Total() const { return user + nice + system + idle + iowait + irq + softirq + steal; }
+};
+
+// Categories of busy (and iowait) CPU time, in /proc/stat order; idle is the rest
+enum CpuCategory { CpuUser, CpuNice, CpuSystem, CpuIoWait, CpuIrq, CpuSoftIrq, CpuSteal, CpuCategoryCount };
+
+const char* CpuCategoryName(int category);
+
+// Share of the time between prev and cur spent in each category, percent of
+// all CPUs; whatever is left up to 100 was idle. iowait is idle time with
+// I/O outstanding and steal is time the hypervisor ran something else.
+void CpuTimeBreakdown(const CpuTimes& cur, const CpuTimes& prev, float (&out)[CpuCategoryCount]);
+
+// The parts of /proc/stat the hardware tab uses. The vectors only grow, so
+// parsing into the same object again doesn't allocate.
+struct SystemStat {
+    CpuTimes total;
+    std::vector<CpuTimes> cores;    // indexed by the N of "cpuN"
+    std::vector<uint8_t> coreOnline; // 0 for cores without a line (offline)
+    uint64_t interrupts = 0;         // "intr" total since boot
+    uint64_t contextSwitches = 0;    // "ctxt"
+    uint32_t procsRunning = 0;
+    uint32_t procsBlocked = 0;
+};
+
+// Parses the contents of /proc/stat in one pass. Returns false if the
+// aggregate "cpu" line is missing.
+bool ParseSystemStat(const char* data, size_t len, SystemStat& out);
+
+#if defined(__linux__)
+// Keeps /proc/stat open and re-reads it with pread into a buffer that only
+// grows (the intr line alone runs to tens of kilobytes on large machines), so
+// a sample is one syscall and no allocation.
+class SystemStatReader {
+public:
+    explicit SystemStatReader(const char* path = "/proc/stat");
+    ~SystemStatReader();
+
+    SystemStatReader(const SystemStatReader&) = delete;
+    SystemStatReader& operator=(const SystemStatReader&) = delete;
+
+    bool IsOpen() const { return m_fd >= 0; }
+
+    // False if the file can't be read or parsed; out is then unspecified
+    bool Read(SystemStat& out);
+
+private:
+    int m_fd = -1;
+    std::vector<char> m_buffer;
+};
+#endif
@@ -0,0 +1,121 @@
+#include "ThreadSampler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+ThreadSampler::ThreadSampler(std::chrono::milliseconds interval)
+    : m_interval(interval), m_latest(std::make_shared<ThreadList>()) {
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) m_ticksPerSecond = static_cast<double>(ticks);
+    m_thread = std::thread(&ThreadSampler::Run, this);
+}
+
+ThreadSampler::~ThreadSampler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void ThreadSampler::SetTarget(int pid) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_target == pid) return;
+        m_target = pid;
+    }
+    m_cv.notify_all();
+}
+
+std::shared_ptr<const ThreadList> ThreadSampler::Latest() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_latest;
+}
+
+void ThreadSampler::Run() {
+    std::unique_ptr<ProcScanner> scanner;
+    int current = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        if (m_target != current) {
+            current = m_target;
+            lock.unlock();
+            scanner.reset(); // closes the previous target's descriptors
+            m_prev.clear();
+            m_lastSample = {};
+            auto empty = std::make_shared<ThreadList>();
+            empty->pid = current;
+            if (current != 0) {
+                char root[48];
+                std::snprintf(root, sizeof(root), "/proc/%d/task", current);
+                // One thread, no io_uring: a few hundred cached preads per sample
+                scanner = std::make_unique<ProcScanner>(root, 1, false);
+                scanner->SetParseProcessor(true);
+                scanner->SetFdShare(FdShare::Threads);
+            }
+            lock.lock();
+            empty->version = ++m_version;
+            m_latest = std::move(empty);
+            continue;
+        }
+        if (current == 0) {
+            m_cv.wait(lock, [&] { return m_stop || m_target != current; });
+            continue;
+        }
+
+        lock.unlock();
+        Sample(*scanner, current);
+        lock.lock();
+        m_cv.wait_for(lock, m_interval, [&] { return m_stop || m_target != current; });
+    }
+}
+
+void ThreadSampler::Sample(ProcScanner& scanner, int pid) {
+    auto now = std::chrono::steady_clock::now();
+    bool ok = scanner.Scan(m_records);
+
+    auto list = std::make_shared<ThreadList>();
+    list->pid = pid;
+    list->alive = ok && !m_records.empty();
+    double elapsedTicks = 0.0;
+    if (m_lastSample != std::chrono::steady_clock::time_point{}) {
+        std::chrono::duration<double> elapsed = now - m_lastSample;
+        elapsedTicks = elapsed.count() * m_ticksPerSecond;
+        list->intervalMs = static_cast<float>(elapsed.count() * 1000.0);
+    }
+    m_lastSample = now;
+
+    list->threads.reserve(m_records.size());
+    m_next.clear();
+    for (const auto& rec : m_records) {
+        ThreadInfo t;
+        t.tid = rec.pid;
+        std::memcpy(t.name, rec.comm, std::min(sizeof(t.name) - 1, static_cast<size_t>(rec.commLen)));
+        t.state = rec.state;
+        t.lastCpu = rec.processor;
+        t.cpuTicks = rec.utime + rec.stime;
+        auto it = m_prev.find(rec.pid);
+        // A reused tid has a new start time and gets no rate until its next sample
+        if (elapsedTicks > 0.0 && it != m_prev.end() && it->second.startTime == rec.startTime &&
+            t.cpuTicks >= it->second.ticks) {
+            t.cpuPercent = static_cast<float>(static_cast<double>(t.cpuTicks - it->second.ticks) * 100.0 / elapsedTicks);
+        }
+        m_next[rec.pid] = PrevTicks{rec.startTime, t.cpuTicks};
+        list->threads.push_back(t);
+    }
+    m_prev.swap(m_next);
+
+    std::sort(list->threads.begin(), list->threads.end(), [](const ThreadInfo& a, const ThreadInfo& b) {
+        if (a.cpuPercent != b.cpuPercent) return a.cpuPercent > b.cpuPercent;
+        return a.tid < b.tid;
+    });
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    list->version = ++m_version;
+    m_latest = std::move(list);
+}
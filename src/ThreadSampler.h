@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__)
+#include "ProcScanner.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#endif
+
+struct ThreadInfo {
+    int tid = 0;
+    char name[16]{};          // TASK_COMM_LEN
+    char state = '?';
+    int lastCpu = -1;         // CPU the thread last ran on
+    float cpuPercent = 0.0f;  // 100 = one fully busy core
+    unsigned long long cpuTicks = 0;
+};
+
+struct ThreadList {
+    int pid = 0;              // 0 when nothing is selected
+    bool alive = false;       // false once the process has exited
+    uint64_t version = 0;
+    float intervalMs = 0.0f;  // time covered by cpuPercent
+    std::vector<ThreadInfo> threads; // busiest first
+};
+
+#if defined(__linux__)
+// Samples the threads of one selected process at a higher rate than the
+// global scan. It runs on its own thread and sleeps while no target is set.
+// Samples are read through a dedicated ProcScanner rooted at
+// /proc/<pid>/task, so the global scan never pays for them. Thread stat
+// descriptors stay cached between samples, up to the Threads share of the
+// descriptor pool, so each sample costs about one pread per thread.
+class ThreadSampler {
+public:
+    explicit ThreadSampler(std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+    ~ThreadSampler();
+
+    ThreadSampler(const ThreadSampler&) = delete;
+    ThreadSampler& operator=(const ThreadSampler&) = delete;
+
+    // 0 stops sampling
+    void SetTarget(int pid);
+
+    // Most recent sample; never null
+    std::shared_ptr<const ThreadList> Latest() const;
+
+private:
+    struct PrevTicks {
+        unsigned long long startTime = 0;
+        unsigned long long ticks = 0;
+    };
+
+    void Run();
+    void Sample(ProcScanner& scanner, int pid);
+
+    const std::chrono::milliseconds m_interval;
+    double m_ticksPerSecond = 100.0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    int m_target = 0;
+    bool m_stop = false;
+    uint64_t m_version = 0;
+    std::shared_ptr<const ThreadList> m_latest;
+
+    // Sampler thread only
+    std::vector<ProcStatRecord> m_records;
+    std::unordered_map<int, PrevTicks> m_prev;
+    std::unordered_map<int, PrevTicks> m_next;
+    std::chrono::steady_clock::time_point m_lastSample{};
+
+    std::thread m_thread;
+};
+#endif
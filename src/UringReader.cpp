@@ -0,0 +1,232 @@
+#include "UringReader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace {
+int IoUringSetup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int IoUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int fd, unsigned opcode, void* arg, unsigned nrArgs) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+template <typename T>
+T* RingPtr(void* base, unsigned offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+} // namespace
+
+UringReader::UringReader(size_t slotBytes)
+    : m_slotBytes(slotBytes), m_slots(BatchSize), m_data(BatchSize * slotBytes) {
+    if (!Setup()) Teardown();
+}
+
+UringReader::~UringReader() {
+    Teardown();
+}
+
+bool UringReader::Setup() {
+    io_uring_params params{};
+    m_ringFd = IoUringSetup(BatchSize, &params);
+    if (m_ringFd < 0) return false;
+
+    // openat/read/close all arrived in 5.6; older kernels get the syscall path
+    constexpr unsigned ProbeOps = 64;
+    size_t probeBytes = sizeof(io_uring_probe) + ProbeOps * sizeof(io_uring_probe_op);
+    auto probeBuf = std::make_unique<unsigned char[]>(probeBytes);
+    std::memset(probeBuf.get(), 0, probeBytes);
+    auto* probe = reinterpret_cast<io_uring_probe*>(probeBuf.get());
+    if (IoUringRegister(m_ringFd, IORING_REGISTER_PROBE, probe, ProbeOps) < 0) return false;
+    for (unsigned op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+    }
+
+    m_sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) {
+        m_sqRingBytes = m_cqRingBytes = std::max(m_sqRingBytes, m_cqRingBytes);
+    }
+
+    m_sqRing = mmap(nullptr, m_sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ringFd, IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED) {
+        m_sqRing = nullptr;
+        return false;
+    }
+    if (singleMmap) {
+        m_cqRing = m_sqRing;
+    } else {
+        m_cqRing = mmap(nullptr, m_cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ringFd, IORING_OFF_CQ_RING);
+        if (m_cqRing == MAP_FAILED) {
+            m_cqRing = nullptr;
+            return false;
+        }
+    }
+
+    m_sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, m_sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    m_sqHead = RingPtr<unsigned>(m_sqRing, params.sq_off.head);
+    m_sqTail = RingPtr<unsigned>(m_sqRing, params.sq_off.tail);
+    m_sqMask = RingPtr<unsigned>(m_sqRing, params.sq_off.ring_mask);
+    m_sqArray = RingPtr<unsigned>(m_sqRing, params.sq_off.array);
+    m_cqHead = RingPtr<unsigned>(m_cqRing, params.cq_off.head);
+    m_cqTail = RingPtr<unsigned>(m_cqRing, params.cq_off.tail);
+    m_cqMask = RingPtr<unsigned>(m_cqRing, params.cq_off.ring_mask);
+    m_cqes = RingPtr<io_uring_cqe>(m_cqRing, params.cq_off.cqes);
+    return true;
+}
+
+void UringReader::Teardown() {
+    if (m_sqes) munmap(m_sqes, m_sqesBytes);
+    if (m_cqRing && m_cqRing != m_sqRing) munmap(m_cqRing, m_cqRingBytes);
+    if (m_sqRing) munmap(m_sqRing, m_sqRingBytes);
+    if (m_ringFd >= 0) close(m_ringFd);
+    m_sqes = nullptr;
+    m_sqRing = m_cqRing = nullptr;
+    m_ringFd = -1;
+}
+
+int UringReader::Add(int dirfd, const char* path, bool keepOpen) {
+    if (m_count >= BatchSize) return -1;
+    size_t len = std::strlen(path);
+    Slot& slot = m_slots[m_count];
+    if (len >= sizeof(slot.path)) return -1;
+    std::memcpy(slot.path, path, len + 1);
+    slot.dirfd = dirfd;
+    slot.fd = -1;
+    slot.bytes = 0;
+    slot.error = 0;
+    slot.ownsFd = true;
+    slot.keepOpen = keepOpen;
+    return static_cast<int>(m_count++);
+}
+
+int UringReader::AddFd(int fd) {
+    if (m_count >= BatchSize) return -1;
+    Slot& slot = m_slots[m_count];
+    slot.dirfd = -1;
+    slot.path[0] = '\0';
+    slot.fd = fd;
+    slot.bytes = 0;
+    slot.error = 0;
+    slot.ownsFd = false;
+    slot.keepOpen = true;
+    return static_cast<int>(m_count++);
+}
+
+int UringReader::Fd(int slot) const {
+    const Slot& s = m_slots[static_cast<size_t>(slot)];
+    return s.ownsFd && s.keepOpen && s.bytes > 0 ? s.fd : -1;
+}
+
+std::string_view UringReader::Result(int slot) const {
+    const Slot& s = m_slots[static_cast<size_t>(slot)];
+    if (s.bytes <= 0) return {};
+    return {m_data.data() + static_cast<size_t>(slot) * m_slotBytes, static_cast<size_t>(s.bytes)};
+}
+
+bool UringReader::Submit(size_t& syscalls) {
+    if (m_count == 0) return true;
+    if (m_ringFd < 0) return false;
+
+    bool ok = RunPhase(Phase::Open, syscalls) && RunPhase(Phase::Read, syscalls) &&
+              RunPhase(Phase::Close, syscalls);
+    if (!ok) {
+        // Don't leak whatever the open phase managed to create
+        for (size_t i = 0; i < m_count; ++i) {
+            if (m_slots[i].ownsFd && m_slots[i].fd >= 0) close(m_slots[i].fd);
+            m_slots[i].fd = -1;
+            m_slots[i].bytes = 0;
+        }
+        Teardown();
+    }
+    return ok;
+}
+
+bool UringReader::RunPhase(Phase phase, size_t& syscalls) {
+    unsigned tail = *m_sqTail;
+    unsigned mask = *m_sqMask;
+    unsigned queued = 0;
+
+    for (size_t i = 0; i < m_count; ++i) {
+        Slot& s = m_slots[i];
+        if (phase == Phase::Open && !s.ownsFd) continue;
+        if (phase != Phase::Open && s.fd < 0) continue;
+        // Keep descriptors the caller owns or asked for, unless the read failed
+        if (phase == Phase::Close && (!s.ownsFd || (s.keepOpen && s.bytes > 0))) continue;
+
+        unsigned idx = tail & mask;
+        io_uring_sqe* sqe = &m_sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = i;
+        switch (phase) {
+        case Phase::Open:
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = s.dirfd;
+            sqe->addr = reinterpret_cast<unsigned long long>(s.path);
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            break;
+        case Phase::Read:
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = s.fd;
+            sqe->addr = reinterpret_cast<unsigned long long>(m_data.data() + i * m_slotBytes);
+            sqe->len = static_cast<unsigned>(m_slotBytes);
+            sqe->off = 0;
+            break;
+        case Phase::Close:
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = s.fd;
+            break;
+        }
+        m_sqArray[idx] = idx;
+        ++tail;
+        ++queued;
+    }
+    if (queued == 0) return true;
+    __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+
+    unsigned completed = 0;
+    while (completed < queued) {
+        unsigned toSubmit = tail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+        int ret = IoUringEnter(m_ringFd, toSubmit, queued - completed, IORING_ENTER_GETEVENTS);
+        ++syscalls;
+        if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+
+        unsigned head = *m_cqHead;
+        unsigned cqTail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        for (; head != cqTail; ++head, ++completed) {
+            const io_uring_cqe& cqe = m_cqes[head & *m_cqMask];
+            Slot& s = m_slots[cqe.user_data];
+            switch (phase) {
+            case Phase::Open:
+                s.fd = cqe.res; // -errno if the process is gone, or out of descriptors
+                if (cqe.res < 0) s.error = -cqe.res;
+                break;
+            case Phase::Read: s.bytes = cqe.res; break;
+            case Phase::Close: s.fd = -1; break;
+            }
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// Batched small-file reader on top of raw io_uring syscalls (no liburing).
+// Queued files are opened, read and closed in three submissions per batch,
+// so a batch of BatchSize files costs three kernel transitions instead of
+// three per file. Already-open descriptors skip the open and close phases.
+// Each file lands in a fixed-size slot buffer.
+class UringReader {
+public:
+    static constexpr unsigned BatchSize = 256;
+
+    explicit UringReader(size_t slotBytes);
+    ~UringReader();
+
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    // False if the kernel lacks io_uring or the openat/read/close opcodes
+    // (or if it is disabled by sysctl); callers use plain syscalls instead.
+    bool IsAvailable() const { return m_ringFd >= 0; }
+
+    // Queues dirfd/path for the next Submit(). Returns the slot index,
+    // or -1 when the batch is full. With keepOpen the descriptor survives
+    // a successful read and is handed over through Fd().
+    int Add(int dirfd, const char* path, bool keepOpen = false);
+
+    // Queues a read at offset 0 of a descriptor the caller owns
+    int AddFd(int fd);
+    size_t Pending() const { return m_count; }
+
+    // Opens, reads and closes every queued file. Returns false if the ring
+    // failed; all slots are then empty and the reader disables itself.
+    bool Submit(size_t& syscalls);
+
+    // Contents of a slot after Submit(); empty if the file couldn't be read
+    std::string_view Result(int slot) const;
+
+    // errno of a slot whose open failed, else 0
+    int Error(int slot) const { return m_slots[static_cast<size_t>(slot)].error; }
+
+    // Descriptor kept open for a keepOpen slot whose read succeeded, else -1.
+    // Ownership passes to the caller.
+    int Fd(int slot) const;
+
+    // Clears queued files and results for the next batch
+    void Reset() { m_count = 0; }
+
+private:
+    enum class Phase { Open, Read, Close };
+
+    bool Setup();
+    void Teardown();
+    bool RunPhase(Phase phase, size_t& syscalls);
+
+    int m_ringFd = -1;
+    void* m_sqRing = nullptr;
+    void* m_cqRing = nullptr;
+    size_t m_sqRingBytes = 0;
+    size_t m_cqRingBytes = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqesBytes = 0;
+
+    unsigned* m_sqHead = nullptr;
+    unsigned* m_sqTail = nullptr;
+    unsigned* m_sqMask = nullptr;
+    unsigned* m_sqArray = nullptr;
+    unsigned* m_cqHead = nullptr;
+    unsigned* m_cqTail = nullptr;
+    unsigned* m_cqMask = nullptr;
+    io_uring_cqe* m_cqes = nullptr;
+
+    struct Slot {
+        int dirfd = -1;
+        char path[32]{};
+        int fd = -1;
+        int bytes = 0; // read() result, <= 0 on failure
+        int error = 0; // open() errno
+        bool ownsFd = true;
+        bool keepOpen = false;
+    };
+
+    size_t m_slotBytes;
+    std::vector<Slot> m_slots;
+    std::vector<char> m_data; // BatchSize * m_slotBytes
+    size_t m_count = 0;
+};
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <numeric>
 #include <string>
 
 #include <glad/glad.h>
@@ -14,6 +19,206 @@ static void GlfwErrorCallback(int error, const char* description) {
     std::cerr << "GLFW Error " << error << ": " << description << '\n';
 }
 
+static void FormatBytes(char* buf, size_t size, unsigned long long bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4) {
+        value /= 1024.0;
+        ++unit;
+    }
+    std::snprintf(buf, size, unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+}
+
+// Sortable columns of the Processes table, as ImGui column user ids
+enum ProcColumn : ImGuiID {
+    ProcColNone,
+    ProcColPid,
+    ProcColName,
+    ProcColCpu,
+    ProcColRead,
+    ProcColWrite,
+    ProcColRss,
+    ProcColPss,
+    ProcColUss,
+    ProcColSwap,
+    ProcColThreads,
+    ProcColState,
+    ProcColTreeCpu,
+    ProcColTreeRss,
+    ProcColDescendants,
+};
+
+// Display order of rows by one column. Ties keep the list's own order, and
+// rows with no I/O or memory sample sort below every sampled one.
+static void SortProcessRows(const std::vector<ProcessInfo>& rows, ImGuiID column, bool ascending,
+                            std::vector<uint32_t>& order) {
+    order.resize(rows.size());
+    std::iota(order.begin(), order.end(), 0u);
+    if (column == ProcColNone) return;
+    auto key = [column](const ProcessInfo& p) -> double {
+        switch (column) {
+        case ProcColPid: return p.pid;
+        case ProcColCpu: return p.cpuPercent;
+        case ProcColRead: return p.hasIo ? p.ioReadRate : -1.0;
+        case ProcColWrite: return p.hasIo ? p.ioWriteRate : -1.0;
+        case ProcColRss: return static_cast<double>(p.rssBytes);
+        case ProcColPss: return p.memSampled ? static_cast<double>(p.pssBytes) : -1.0;
+        case ProcColUss: return p.memSampled ? static_cast<double>(p.ussBytes) : -1.0;
+        case ProcColSwap: return p.memSampled ? static_cast<double>(p.swapBytes) : -1.0;
+        case ProcColThreads: return p.threads;
+        case ProcColState: return p.state;
+        case ProcColTreeCpu: return p.subtreeCpu;
+        case ProcColTreeRss: return static_cast<double>(p.subtreeRss);
+        case ProcColDescendants: return p.descendants;
+        default: return 0.0;
+        }
+    };
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const ProcessInfo& x = rows[a];
+        const ProcessInfo& y = rows[b];
+        if (column == ProcColName) {
+            const int c = std::strcmp(x.name, y.name);
+            return ascending ? c < 0 : c > 0;
+        }
+        return ascending ? key(x) < key(y) : key(x) > key(y);
+    });
+}
+
+// Dim blue for idle through neon cyan to red for a saturated core
+static ImU32 HeatColor(float t) {
+    auto mix = [](float a, float b, float f) { return static_cast<int>(a + (b - a) * f); };
+    if (t < 0.5f) {
+        const float f = t * 2.0f;
+        return IM_COL32(0, mix(40, 200, f), mix(90, 255, f), 230);
+    }
+    const float f = (t - 0.5f) * 2.0f;
+    return IM_COL32(mix(0, 255, f), mix(200, 70, f), mix(255, 60, f), 230);
+}
+
+// Cores as rows, time left to right (newest at the right edge). Samples are
+// quantised to a few shades and each run of equal shade is one rectangle;
+// with more cores than pixel rows, neighbouring cores share a row and the
+// busiest one sets its shade. So the vertex count is bounded by the
+// widget's size rather than growing with the core count.
+static void DrawCoreHeatmap(const CoreHistory& hist, float height) {
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 size(ImGui::GetContentRegionAvail().x, height);
+    ImGui::InvisibleButton("##coreheatmap", size);
+    const size_t cores = hist.Cores();
+    const size_t samples = hist.Size();
+    if (cores == 0 || samples == 0 || size.x <= 0.0f) return;
+
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    draw->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), HeatColor(0.0f));
+
+    constexpr float MinRowHeight = 2.0f;
+    constexpr int Shades = 16;
+    const size_t maxRows = std::max<size_t>(1, static_cast<size_t>(size.y / MinRowHeight));
+    const size_t coresPerRow = (cores + maxRows - 1) / maxRows;
+    const size_t rows = (cores + coresPerRow - 1) / coresPerRow;
+    const float rowHeight = size.y / static_cast<float>(rows);
+    const float colWidth = size.x / static_cast<float>(hist.Length());
+    const float left = origin.x + size.x - colWidth * static_cast<float>(samples);
+
+    for (size_t row = 0; row < rows; ++row) {
+        const size_t first = row * coresPerRow;
+        const size_t last = std::min(cores, first + coresPerRow);
+        const float top = origin.y + rowHeight * static_cast<float>(row);
+        int runShade = 0;
+        size_t runStart = 0;
+        auto flush = [&](size_t end) {
+            if (runShade == 0) return; // background already has the idle shade
+            draw->AddRectFilled(ImVec2(left + colWidth * static_cast<float>(runStart), top),
+                                ImVec2(left + colWidth * static_cast<float>(end), top + rowHeight),
+                                HeatColor(static_cast<float>(runShade) / (Shades - 1)));
+        };
+        for (size_t i = 0; i < samples; ++i) {
+            const float* sample = hist.Row(i);
+            float busiest = 0.0f;
+            for (size_t core = first; core < last; ++core) busiest = std::max(busiest, sample[core]);
+            const int shade = std::clamp(static_cast<int>(busiest / 100.0f * (Shades - 1) + 0.5f), 0, Shades - 1);
+            if (shade != runShade) {
+                flush(i);
+                runShade = shade;
+                runStart = i;
+            }
+        }
+        flush(samples);
+    }
+
+    if (ImGui::IsItemHovered()) {
+        const ImVec2 mouse = ImGui::GetMousePos();
+        const size_t row = std::min(rows - 1, static_cast<size_t>((mouse.y - origin.y) / rowHeight));
+        const size_t first = row * coresPerRow;
+        const size_t last = std::min(cores, first + coresPerRow) - 1;
+        const float* newest = hist.Row(samples - 1);
+        float busiest = 0.0f;
+        for (size_t core = first; core <= last; ++core) busiest = std::max(busiest, newest[core]);
+        if (first == last) {
+            ImGui::SetTooltip("CPU %zu: %.0f%%", first, busiest);
+        } else {
+            ImGui::SetTooltip("CPU %zu-%zu: busiest %.0f%%", first, last, busiest);
+        }
+    }
+}
+
+// One colour per CpuCategory; iowait and steal stand out since they mean waiting, not work
+static const ImU32 CpuCategoryColors[CpuCategoryCount] = {
+    IM_COL32(0, 170, 255, 220),  // user
+    IM_COL32(60, 90, 200, 220),  // nice
+    IM_COL32(200, 80, 255, 220), // system
+    IM_COL32(255, 210, 0, 220),  // iowait
+    IM_COL32(255, 140, 0, 220),  // irq
+    IM_COL32(255, 180, 90, 220), // softirq
+    IM_COL32(255, 50, 50, 220),  // steal
+};
+
+// Stacked areas of every CpuCategory, user at the bottom, 0..100% of all CPUs
+static void DrawCpuTimeStack(const SeriesHistory& hist, float height) {
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 size(ImGui::GetContentRegionAvail().x, height);
+    ImGui::InvisibleButton("##cputimestack", size);
+    const size_t samples = hist.Size();
+    if (hist.SeriesCount() != CpuCategoryCount || samples < 2 || size.x <= 0.0f) return;
+
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    draw->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(0, 20, 40, 160));
+
+    const float colWidth = size.x / static_cast<float>(hist.Length() - 1);
+    const float right = origin.x + size.x;
+    auto y = [&](float percent) { return origin.y + size.y * (1.0f - std::min(percent, 100.0f) / 100.0f); };
+    for (size_t i = 1; i < samples; ++i) {
+        const float x0 = right - colWidth * static_cast<float>(samples - i);
+        const float x1 = x0 + colWidth;
+        float base0 = 0.0f;
+        float base1 = 0.0f;
+        for (int c = 0; c < CpuCategoryCount; ++c) {
+            const float v0 = hist.Value(static_cast<size_t>(c), i - 1);
+            const float v1 = hist.Value(static_cast<size_t>(c), i);
+            if (v0 > 0.0f || v1 > 0.0f) {
+                draw->AddQuadFilled(ImVec2(x0, y(base0)), ImVec2(x1, y(base1)), ImVec2(x1, y(base1 + v1)),
+                                    ImVec2(x0, y(base0 + v0)), CpuCategoryColors[c]);
+            }
+            base0 += v0;
+            base1 += v1;
+        }
+    }
+
+    if (ImGui::IsItemHovered()) {
+        // Nearest sample under the mouse
+        const float fromRight = right - ImGui::GetMousePos().x;
+        const size_t back = std::min(samples - 1, static_cast<size_t>(std::max(0.0f, fromRight / colWidth + 0.5f)));
+        const size_t i = samples - 1 - back;
+        ImGui::BeginTooltip();
+        for (int c = 0; c < CpuCategoryCount; ++c) {
+            ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(CpuCategoryColors[c]), "%-8s %5.1f%%", CpuCategoryName(c),
+                               hist.Value(static_cast<size_t>(c), i));
+        }
+        ImGui::EndTooltip();
+    }
+}
+
 class App {
 public:
     App() = default;
@@ -29,6 +234,11 @@ private:
     void RenderUI();
 
     void SetupImGuiStyle();
+    void RenderThreadPanel();
+    void RenderPinnedTab();
+    void RenderTopTab();
+    void RenderCgroupsTab();
+    void RenderHeavyHitters();
 
 private:
     GLFWwindow* m_window = nullptr;
@@ -37,6 +247,26 @@ private:
     SystemMonitor m_monitor;
     std::string m_procFilter;
     char m_procFilterBuf[128]{};
+    int m_procSearchMode = 0; // SearchMode
+    bool m_procTreeView = false;
+    int m_selectedPid = 0; // thread drill-down target
+    unsigned long long m_selectedStartTime = 0;
+    std::shared_ptr<const ProcessList> m_procList; // kept across frames; refreshed only on change
+    ImGuiID m_procSortColumn = ProcColNone; // ProcColumn
+    bool m_procSortAscending = false;
+    std::vector<uint32_t> m_procOrder; // display order of m_procList's rows
+    uint64_t m_procOrderVersion = 0;   // list version m_procOrder was sorted for
+    int m_smapsBudgetMs = 5;
+    int m_hitterWindow = 0; // index into the 1 min / 15 min / 1 h choices
+    int m_hitterMetric = 0; // HitterMetric
+    std::vector<HeavyHitter> m_hitters;
+    int m_topMetric = 0; // TopMetric
+    int m_topCount = 20;
+    char m_pinPatternBuf[64]{};
+    int m_pinRateHz = 50;
+    std::vector<PinnedSeries> m_pinned; // reused every frame
+    int m_sampleRateHz = SystemMonitor::DefaultSampleRateHz;
+    std::shared_ptr<const HardwareSnapshot> m_hardware; // latest published sample, shared with the sampler
 
     // UI state
     std::string m_lastError;
@@ -87,6 +317,8 @@ bool App::Init() {
     ImGui_ImplGlfw_InitForOpenGL(m_window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
+    // Sampling runs on its own threads from here on, whatever the frame rate
+    m_monitor.StartSampling();
     m_running = true;
     return true;
 }
@@ -140,7 +372,6 @@ void App::Run() {
         if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(m_window, 1);
         }
-        m_monitor.Update();
         NewFrame();
         RenderUI();
         Render();
@@ -196,15 +427,49 @@ void App::RenderUI() {
 
     if (ImGui::BeginTabBar("MainTabs")) {
         if (ImGui::BeginTabItem("Hardware")) {
-            HardwareStats stats = m_monitor.GetHardwareStats();
-            const std::vector<float>& hist = m_monitor.GetCpuHistory();
+            m_hardware = m_monitor.GetHardware();
+            const HardwareStats& stats = m_hardware->stats;
+            const std::vector<float>& hist = *m_hardware->cpuHistory;
 
             ImGui::Text("CPU Load: %.1f%%", stats.cpuLoadPercent);
+            ImGui::SetNextItemWidth(200.0f);
+            if (ImGui::SliderInt("Sample rate (Hz)", &m_sampleRateHz, 1, static_cast<int>(SystemMonitor::MaxSampleRateHz),
+                                 "%d", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp)) {
+                m_monitor.SetSampleRate(static_cast<unsigned>(m_sampleRateHz));
+            }
+            if (stats.sampleRateHz > 0) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("history spans %.1f s, %u samples per point, %llu late samples",
+                                    static_cast<float>(hist.size() * m_hardware->historyStride) /
+                                        static_cast<float>(stats.sampleRateHz),
+                                    m_hardware->historyStride, static_cast<unsigned long long>(stats.missedSamples));
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Late samples are timer periods the sampler overran; each is filled with the "
+                                      "next sample so the graphs stay evenly spaced. CPU time is counted in 10 ms "
+                                      "kernel ticks, so every sample is averaged over the last 100 ms.");
+                }
+            }
             if (!hist.empty()) {
                 ImGui::PlotLines("CPU History", hist.data(),
                                  static_cast<int>(hist.size()),
                                  0, nullptr, 0.0f, 100.0f, ImVec2(0, 120));
             }
+            if (stats.hasCpuTimes) {
+                // Legend doubles as the current breakdown
+                for (int c = 0; c < CpuCategoryCount; ++c) {
+                    if (c > 0) ImGui::SameLine();
+                    ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(CpuCategoryColors[c]), "%s %.1f%%",
+                                       CpuCategoryName(c), stats.cpuTimePercent[c]);
+                }
+                DrawCpuTimeStack(*m_hardware->cpuTimeHistory, 120.0f);
+            }
+            if (stats.coreCount > 0) {
+                ImGui::Text("Per core (%d): busiest is CPU %d at %.0f%%", stats.coreCount, stats.busiestCore,
+                            stats.busiestCorePercent);
+                ImGui::Text("Context switches: %.0f/s  Interrupts: %.0f/s  Runnable: %d  Blocked on I/O: %d",
+                            stats.contextSwitchRate, stats.interruptRate, stats.procsRunning, stats.procsBlocked);
+                DrawCoreHeatmap(*m_hardware->coreHistory, std::clamp(4.0f * static_cast<float>(stats.coreCount), 48.0f, 256.0f));
+            }
 
             ImGui::Separator();
             ImGui::Text("RAM: %.2f / %.2f GB",
@@ -215,30 +480,227 @@ void App::RenderUI() {
 
         if (ImGui::BeginTabItem("Processes")) {
             ImGui::Text("Process Manager");
-            ImGui::InputTextWithHint("##filter", "Search by name or PID",
+            ImGui::InputTextWithHint("##filter", "Search by PID, name or command line",
                                      m_procFilterBuf, sizeof(m_procFilterBuf));
             m_procFilter = m_procFilterBuf;
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(110.0f);
+            const char* searchModes[] = {"Substring", "Fuzzy", "Regex"};
+            ImGui::Combo("##searchmode", &m_procSearchMode, searchModes, IM_ARRAYSIZE(searchModes));
+            ImGui::SameLine();
+            ImGui::Checkbox("Tree", &m_procTreeView);
 
-            auto procs = m_monitor.GetProcesses(m_procFilter);
+            m_procList = m_monitor.GetProcesses(m_procFilter, static_cast<SearchMode>(m_procSearchMode),
+                                                m_procTreeView);
+            if (!m_procList->error.empty()) {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Regex: %s", m_procList->error.c_str());
+            }
+            const std::vector<ProcessInfo>& procs = m_procList->rows;
+            ProcessScanStats scan = m_monitor.GetProcessScanStats();
             ImGui::Text("Total: %zu", procs.size());
+            ImGui::SameLine();
+            ImGui::TextDisabled("(scan %.2f ms, %zu syscalls)", scan.scanMs, scan.syscalls);
+            if (scan.scanError != 0) {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Scan failed: %s; showing the last good one",
+                                   std::strerror(scan.scanError));
+            }
+            if (scan.uringThreads > 0) {
+                ImGui::SameLine();
+                if (scan.uringThreads == scan.scanThreads) {
+                    ImGui::TextDisabled("io_uring");
+                } else {
+                    // A ring that failed at runtime leaves its thread on plain syscalls
+                    ImGui::TextDisabled("io_uring on %zu of %zu threads", scan.uringThreads, scan.scanThreads);
+                }
+            }
+            std::shared_ptr<const ProcessDelta> delta = m_monitor.GetProcessDelta();
+            ImGui::SameLine();
+            ImGui::TextDisabled("+%zu -%zu ~%zu", delta->added.size(), delta->removed.size(),
+                                delta->changed.size());
+            if (scan.fdBudget > 0) {
+                ImGui::TextDisabled("Stat fd cache: %zu / %zu, %zu evicted", scan.cachedFds, scan.fdBudget,
+                                    scan.evictedFds);
+                ImGui::SameLine();
+            }
+            ImGui::TextDisabled("Names: %zu distinct, %zu KB pooled", scan.uniqueNames,
+                                scan.namePoolBytes / 1024);
+            ImGui::SameLine();
+            ImGui::TextDisabled("Search index: %zu KB text, %zu trigrams", scan.indexedBytes / 1024,
+                                scan.indexedTrigrams);
+            ImGui::TextDisabled("smaps_rollup: %zu read in %.1f ms", scan.smapsSamples, scan.smapsMs);
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(120.0f);
+            if (ImGui::SliderInt("ms budget per scan", &m_smapsBudgetMs, 0, 50)) {
+                m_monitor.SetSmapsBudget(std::chrono::milliseconds(m_smapsBudgetMs));
+            }
+            if (scan.eventDriven) {
+                ImGui::TextDisabled("Proc events: %llu forks, %llu exits", scan.forks, scan.exits);
+            } else {
+                ImGui::TextDisabled("Proc events unavailable (needs CAP_NET_ADMIN), polling /proc");
+            }
+            if (ImGui::CollapsingHeader("Heavy hitters")) {
+                RenderHeavyHitters();
+            }
             ImGui::Separator();
 
-            ImGui::BeginChild("ProcList", ImVec2(0, 0), true);
-            for (const auto& p : procs) {
-                ImGui::PushID(p.pid);
-                ImGui::Text("%d  %s", p.pid, p.name.c_str());
-                ImGui::SameLine();
-                if (ImGui::SmallButton("Terminate")) {
-                    std::string err;
-                    if (!m_monitor.TerminateProcess(p.pid, err)) {
-                        m_lastError = "Failed to terminate PID " + std::to_string(p.pid) + ": " + err;
-                    } else {
-                        m_lastError = "Sent terminate to PID " + std::to_string(p.pid);
+            ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV |
+                                         ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+            // Sorting would break up the tree. With no column sorted (a third
+            // click) rows keep the list's order: slot, best match or preorder.
+            if (!m_procTreeView) tableFlags |= ImGuiTableFlags_Sortable | ImGuiTableFlags_SortTristate;
+            // Leave room for the thread panel while a process is selected
+            const float threadPanelHeight = m_selectedPid != 0 ? 240.0f : 0.0f;
+            const ImVec2 procTableSize(0.0f, m_selectedPid != 0 ? ImGui::GetContentRegionAvail().y - threadPanelHeight : 0.0f);
+            if (ImGui::BeginTable("ProcList", 16, tableFlags, procTableSize)) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                // Quantities sort largest first on the first click
+                const ImGuiTableColumnFlags fixed = ImGuiTableColumnFlags_WidthFixed;
+                const ImGuiTableColumnFlags amount = fixed | ImGuiTableColumnFlags_PreferSortDescending;
+                ImGui::TableSetupColumn("PID", fixed, 70.0f, ProcColPid);
+                ImGui::TableSetupColumn("Name", fixed, 160.0f, ProcColName);
+                ImGui::TableSetupColumn("Command", ImGuiTableColumnFlags_WidthStretch | ImGuiTableColumnFlags_NoSort);
+                ImGui::TableSetupColumn("CPU %", amount, 60.0f, ProcColCpu);
+                ImGui::TableSetupColumn("Read/s", amount, 80.0f, ProcColRead);
+                ImGui::TableSetupColumn("Write/s", amount, 80.0f, ProcColWrite);
+                ImGui::TableSetupColumn("RSS", amount, 80.0f, ProcColRss);
+                ImGui::TableSetupColumn("PSS", amount, 80.0f, ProcColPss);
+                ImGui::TableSetupColumn("USS", amount, 80.0f, ProcColUss);
+                ImGui::TableSetupColumn("Swap", amount, 80.0f, ProcColSwap);
+                ImGui::TableSetupColumn("Threads", amount, 60.0f, ProcColThreads);
+                ImGui::TableSetupColumn("State", fixed, 40.0f, ProcColState);
+                ImGui::TableSetupColumn("Tree CPU %", amount, 75.0f, ProcColTreeCpu);
+                ImGui::TableSetupColumn("Tree RSS", amount, 80.0f, ProcColTreeRss);
+                ImGui::TableSetupColumn("Desc.", amount, 50.0f, ProcColDescendants);
+                ImGui::TableSetupColumn("", fixed | ImGuiTableColumnFlags_NoSort, 190.0f);
+                ImGui::TableHeadersRow();
+
+                if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs(); specs && specs->SpecsDirty) {
+                    m_procSortColumn = specs->SpecsCount > 0 ? specs->Specs[0].ColumnUserID : ProcColNone;
+                    m_procSortAscending =
+                        specs->SpecsCount > 0 && specs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+                    specs->SpecsDirty = false;
+                    m_procOrderVersion = 0;
+                }
+                // Re-sorted only when the monitor publishes a new list, not every frame
+                if (m_procOrderVersion != m_procList->version) {
+                    SortProcessRows(procs, m_procTreeView ? ProcColNone : m_procSortColumn, m_procSortAscending,
+                                    m_procOrder);
+                    m_procOrderVersion = m_procList->version;
+                }
+
+                char rss[32];
+                // One snapshot load for the frame, not a lookup per row
+                const std::shared_ptr<const PinnedKeys> pinned = m_monitor.GetPinnedKeys();
+                // Only visible rows are submitted, so details are only loaded for those
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(procs.size()));
+                while (clipper.Step()) {
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                        const ProcessInfo& p = procs[m_procOrder[static_cast<size_t>(row)]];
+                        ImGui::PushID(p.pid);
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", p.pid);
+                        ImGui::TableNextColumn();
+                        const float indent = m_procTreeView ? 12.0f * static_cast<float>(p.depth) : 0.0f;
+                        if (indent > 0.0f) ImGui::Indent(indent);
+                        const ImGuiSelectableFlags rowFlags =
+                            ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap;
+                        if (ImGui::Selectable(p.name, p.pid == m_selectedPid, rowFlags)) {
+                            m_selectedPid = p.pid == m_selectedPid ? 0 : p.pid;
+                            m_selectedStartTime = p.startTime;
+                            m_monitor.SetThreadTarget(m_selectedPid);
+                        }
+                        if (indent > 0.0f) ImGui::Unindent(indent);
+                        ImGui::TableNextColumn();
+                        auto details = m_monitor.GetProcessDetails(ProcessKey{p.pid, p.startTime});
+                        if (!details) {
+                            // Being read on the process thread
+                            ImGui::TextDisabled("%s ...", p.name);
+                        } else if (!details->cmdline.empty()) {
+                            ImGui::TextUnformatted(details->cmdline.c_str());
+                            if (!details->exe.empty() && ImGui::IsItemHovered()) {
+                                ImGui::SetTooltip("%s", details->exe.c_str());
+                            }
+                        } else {
+                            // Kernel threads have no command line
+                            ImGui::TextDisabled("[%s]", p.name);
+                        }
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.1f", p.cpuPercent);
+                        // Blank where /proc/<pid>/io isn't readable (other users' processes)
+                        for (float rate : {p.ioReadRate, p.ioWriteRate}) {
+                            ImGui::TableNextColumn();
+                            if (!p.hasIo) continue;
+                            FormatBytes(rss, sizeof(rss), static_cast<unsigned long long>(rate));
+                            ImGui::TextUnformatted(rss);
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::SetTooltip("%.0f read / %.0f write syscalls/s", p.ioSyscrRate, p.ioSyscwRate);
+                            }
+                        }
+                        ImGui::TableNextColumn();
+                        FormatBytes(rss, sizeof(rss), p.rssBytes);
+                        ImGui::TextUnformatted(rss);
+                        // Sampled in the background; blank until the first sample
+                        for (unsigned long long bytes : {p.pssBytes, p.ussBytes, p.swapBytes}) {
+                            ImGui::TableNextColumn();
+                            if (!p.memSampled) continue;
+                            FormatBytes(rss, sizeof(rss), bytes);
+                            ImGui::TextUnformatted(rss);
+                        }
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", p.threads);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%c", p.state);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.1f", p.subtreeCpu);
+                        ImGui::TableNextColumn();
+                        FormatBytes(rss, sizeof(rss), p.subtreeRss);
+                        ImGui::TextUnformatted(rss);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", p.descendants);
+                        ImGui::TableNextColumn();
+                        const ProcessKey key{p.pid, p.startTime};
+                        const bool isPinned = pinned->Contains(key);
+                        if (ImGui::SmallButton(isPinned ? "Unpin" : "Pin")) {
+                            if (isPinned) {
+                                m_monitor.UnpinProcess(key);
+                            } else {
+                                m_monitor.PinProcess(key);
+                            }
+                        }
+                        ImGui::SameLine();
+                        if (ImGui::SmallButton("Terminate")) {
+                            std::string err;
+                            if (!m_monitor.TerminateProcess(p.pid, err)) {
+                                m_lastError = "Failed to terminate PID " + std::to_string(p.pid) + ": " + err;
+                            } else {
+                                m_lastError = "Sent terminate to PID " + std::to_string(p.pid);
+                            }
+                        }
+                        if (p.descendants > 0) {
+                            ImGui::SameLine();
+                            if (ImGui::SmallButton("Kill tree")) {
+                                std::string err;
+                                if (!m_monitor.TerminateProcessTree(p.pid, err)) {
+                                    m_lastError =
+                                        "Failed to terminate tree of PID " + std::to_string(p.pid) + ": " + err;
+                                } else {
+                                    m_lastError = "Sent terminate to PID " + std::to_string(p.pid) + " and " +
+                                                  std::to_string(p.descendants) + " descendants";
+                                }
+                            }
+                        }
+                        ImGui::PopID();
                     }
                 }
-                ImGui::PopID();
+                ImGui::EndTable();
+            }
+
+            if (m_selectedPid != 0) {
+                RenderThreadPanel();
             }
-            ImGui::EndChild();
 
             if (!m_lastError.empty()) {
                 ImGui::Separator();
@@ -248,6 +710,21 @@ void App::RenderUI() {
             ImGui::EndTabItem();
         }
 
+        if (ImGui::BeginTabItem("Top")) {
+            RenderTopTab();
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem("Cgroups")) {
+            RenderCgroupsTab();
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem("Pinned")) {
+            RenderPinnedTab();
+            ImGui::EndTabItem();
+        }
+
         if (ImGui::BeginTabItem("Weather")) {
             ImGui::Text("Weather - Tashkent (Open-Meteo)");
             if (ImGui::Button("Refresh")) {
@@ -276,6 +753,279 @@ void App::RenderUI() {
     ImGui::End();
 }
 
+void App::RenderThreadPanel() {
+    auto threads = m_monitor.GetThreads();
+    ImGui::Separator();
+    if (ImGui::SmallButton("Close")) {
+        m_selectedPid = 0;
+        m_monitor.SetThreadTarget(0);
+        return;
+    }
+    ImGui::SameLine();
+    if (threads->pid != m_selectedPid || threads->version == 0) {
+        ImGui::Text("Threads of PID %d: sampling...", m_selectedPid);
+        return;
+    }
+    if (!threads->alive) {
+        ImGui::Text("PID %d has exited", m_selectedPid);
+        return;
+    }
+    ImGui::Text("Threads of PID %d: %zu", m_selectedPid, threads->threads.size());
+    ImGui::SameLine();
+    ImGui::TextDisabled("(sampled every %.0f ms)", threads->intervalMs);
+
+    if (ImGui::CollapsingHeader("Environment")) {
+        auto details = m_monitor.GetProcessDetails(ProcessKey{m_selectedPid, m_selectedStartTime}, true);
+        if (!details || !(details->hasEnviron || details->missing)) {
+            ImGui::TextDisabled("Loading...");
+        } else if (details->environ.empty()) {
+            ImGui::TextDisabled("Not readable (other users' processes need root)");
+        } else {
+            ImGui::BeginChild("Environ", ImVec2(0.0f, 100.0f));
+            for (const auto& var : details->environ) ImGui::TextUnformatted(var.c_str());
+            ImGui::EndChild();
+        }
+    }
+
+    ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV |
+                                 ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("ThreadList", 5, tableFlags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("TID", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("CPU %", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_WidthFixed, 40.0f);
+        ImGui::TableSetupColumn("Last CPU", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableHeadersRow();
+        for (const auto& t : threads->threads) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", t.tid);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(t.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", t.cpuPercent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%c", t.state);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", t.lastCpu);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void App::RenderHeavyHitters() {
+    const char* windows[] = {"Last 1 min", "Last 15 min", "Last 1 h"};
+    const std::chrono::seconds windowSpans[] = {std::chrono::minutes(1), std::chrono::minutes(15),
+                                                std::chrono::hours(1)};
+    ImGui::SetNextItemWidth(130.0f);
+    ImGui::Combo("##hitterwindow", &m_hitterWindow, windows, IM_ARRAYSIZE(windows));
+    ImGui::SameLine();
+    const char* metrics[] = {"CPU time", "Disk I/O"};
+    ImGui::SetNextItemWidth(110.0f);
+    ImGui::Combo("##hittermetric", &m_hitterMetric, metrics, IM_ARRAYSIZE(metrics));
+    ImGui::SameLine();
+    ImGui::TextDisabled("by process name");
+
+    const auto metric = static_cast<HitterMetric>(m_hitterMetric);
+    m_monitor.GetHeavyHitters(metric, windowSpans[m_hitterWindow], 20, m_hitters);
+    ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("HeavyHitters", 4, tableFlags, ImVec2(0.0f, 180.0f))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn(metric == HitterMetric::Cpu ? "CPU s" : "Bytes", ImGuiTableColumnFlags_WidthFixed,
+                                80.0f);
+        ImGui::TableSetupColumn("Share", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("+/-", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableHeadersRow();
+        char buf[32];
+        auto amount = [&](double value) {
+            if (metric == HitterMetric::Cpu) {
+                ImGui::Text("%.1f", value);
+            } else {
+                FormatBytes(buf, sizeof(buf), static_cast<unsigned long long>(value));
+                ImGui::TextUnformatted(buf);
+            }
+        };
+        for (const auto& h : m_hitters) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(h.name);
+            ImGui::TableNextColumn();
+            amount(h.amount);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", h.share * 100.0f);
+            ImGui::TableNextColumn();
+            amount(h.error);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void App::RenderTopTab() {
+    ImGui::Text("Top Consumers");
+    ImGui::SetNextItemWidth(110.0f);
+    const char* metrics[] = {"CPU", "Memory", "Disk I/O"};
+    ImGui::Combo("By", &m_topMetric, metrics, IM_ARRAYSIZE(metrics));
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(200.0f);
+    ImGui::SliderInt("Count", &m_topCount, 5, 50);
+
+    auto top = m_monitor.GetTopProcesses(static_cast<TopMetric>(m_topMetric), static_cast<size_t>(m_topCount));
+    ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV |
+                                 ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("TopList", 7, tableFlags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_WidthFixed, 30.0f);
+        ImGui::TableSetupColumn("PID", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("CPU %", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("RSS", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("I/O/s", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("Threads", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableHeadersRow();
+        char rss[32];
+        int rank = 1;
+        for (const auto& p : top->rows) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", rank++);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", p.pid);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(p.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", p.cpuPercent);
+            ImGui::TableNextColumn();
+            FormatBytes(rss, sizeof(rss), p.rssBytes);
+            ImGui::TextUnformatted(rss);
+            ImGui::TableNextColumn();
+            if (p.hasIo) {
+                FormatBytes(rss, sizeof(rss), static_cast<unsigned long long>(p.ioReadRate + p.ioWriteRate));
+                ImGui::TextUnformatted(rss);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", p.threads);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void App::RenderCgroupsTab() {
+    auto cgroups = m_monitor.GetCgroups();
+    if (!cgroups->available) {
+        ImGui::TextDisabled("No cgroup v2 hierarchy found (Linux, /sys/fs/cgroup)");
+        return;
+    }
+    ImGui::Text("Control Groups: %zu active", cgroups->groups.size());
+    ImGui::SameLine();
+    ImGui::TextDisabled("(%zu accounting files read in %.2f ms)", cgroups->fileReads, cgroups->collectMs);
+
+    ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV |
+                                 ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("CgroupList", 9, tableFlags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Cgroup", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Procs", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+        ImGui::TableSetupColumn("CPU %", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("Throttled %", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("Memory", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("Anon", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("Read/s", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("Write/s", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableHeadersRow();
+        char buf[32];
+        for (const auto& g : cgroups->groups) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(g.path.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", g.processes);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", g.cpuPercent);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("user %.1f / system %.1f", g.userPercent, g.systemPercent);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", g.throttledPercent);
+            // Blank where the memory or io controller isn't enabled for the group
+            for (unsigned long long bytes : {g.memoryBytes, g.anonBytes, g.fileBytes}) {
+                ImGui::TableNextColumn();
+                if (!g.hasMemory) continue;
+                FormatBytes(buf, sizeof(buf), bytes);
+                ImGui::TextUnformatted(buf);
+            }
+            for (float rate : {g.ioReadRate, g.ioWriteRate}) {
+                ImGui::TableNextColumn();
+                if (!g.hasIo) continue;
+                FormatBytes(buf, sizeof(buf), static_cast<unsigned long long>(rate));
+                ImGui::TextUnformatted(buf);
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%.0f read / %.0f write ops/s", g.ioReadOpsRate, g.ioWriteOpsRate);
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+void App::RenderPinnedTab() {
+    ImGui::Text("Pinned Processes");
+    bool add = ImGui::InputTextWithHint("##pinpattern", "Pin every process whose name contains...", m_pinPatternBuf,
+                                        sizeof(m_pinPatternBuf), ImGuiInputTextFlags_EnterReturnsTrue);
+    ImGui::SameLine();
+    add |= ImGui::Button("Add pattern");
+    if (add && m_pinPatternBuf[0] != '\0') {
+        m_monitor.AddPinPattern(m_pinPatternBuf);
+        m_pinPatternBuf[0] = '\0';
+    }
+    for (const auto& pattern : m_monitor.GetPinPatterns()) {
+        ImGui::PushID(pattern.c_str());
+        ImGui::BulletText("%s", pattern.c_str());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Remove")) m_monitor.RemovePinPattern(pattern);
+        ImGui::PopID();
+    }
+
+    ImGui::SetNextItemWidth(200.0f);
+    if (ImGui::SliderInt("Sample rate (Hz)", &m_pinRateHz, 1, 100)) {
+        m_monitor.SetPinRate(static_cast<unsigned>(m_pinRateHz));
+    }
+    ImGui::Separator();
+
+    m_monitor.GetPinnedSeries(m_pinned);
+    if (m_pinned.empty()) {
+        ImGui::TextDisabled("Nothing pinned. Use Pin in the Processes tab or add a name pattern.");
+        return;
+    }
+    const float plotWidth = (ImGui::GetContentRegionAvail().x - 8.0f) * 0.5f;
+    char rss[32];
+    for (const auto& s : m_pinned) {
+        ImGui::PushID(s.key.pid);
+        FormatBytes(rss, sizeof(rss), s.rssBytes);
+        if (s.alive) {
+            ImGui::Text("%s (PID %d)  CPU %.1f%%  RSS %s", s.name.c_str(), s.key.pid, s.cpuPercent, rss);
+        } else {
+            ImGui::TextDisabled("%s (PID %d) has exited", s.name.c_str(), s.key.pid);
+        }
+        ImGui::SameLine();
+        if (s.pattern.empty()) {
+            if (ImGui::SmallButton("Unpin")) m_monitor.UnpinProcess(s.key);
+        } else {
+            ImGui::TextDisabled("[%s]", s.pattern.c_str());
+        }
+        if (!s.cpuHistory.empty()) {
+            ImGui::PlotLines("##cpu", s.cpuHistory.data(), static_cast<int>(s.cpuHistory.size()), 0, "CPU %",
+                             0.0f, 100.0f, ImVec2(plotWidth, 60.0f));
+            ImGui::SameLine();
+            ImGui::PlotLines("##rss", s.rssMBHistory.data(), static_cast<int>(s.rssMBHistory.size()), 0, "RSS MB",
+                             FLT_MAX, FLT_MAX, ImVec2(plotWidth, 60.0f));
+        }
+        ImGui::PopID();
+    }
+}
+
 int main() {
     App app;
     if (!app.Init()) {